@@ -3,6 +3,18 @@
 #include <utility>
 #include <stdexcept>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace crn = std::chrono;
 
 template <typename T, size_t N>
 struct Stack {
@@ -25,7 +37,7 @@ T Pop(Stack<T, N>& s) {
     if (StackEmpty(s)) {
         throw std::underflow_error("Stack underflow");
     } else {
-        return s.data[--s.second];
+        return s.data[--s.top];
     }
 }
 
@@ -36,6 +48,16 @@ struct Queue {
     size_t tail = 0;
 };
 
+template <typename T, size_t N>
+bool QueueEmpty(const Queue<T, N>& q) {
+    return q.head == q.tail;
+}
+
+template <typename T, size_t N>
+bool QueueFull(const Queue<T, N>& q) {
+    return (q.tail + 1) % N == q.head;
+}
+
 template <typename T, size_t N>
 void Enqueue(Queue<T, N>& q, const T& x) {
     q.data[q.tail] = x;
@@ -47,7 +69,7 @@ void Enqueue(Queue<T, N>& q, const T& x) {
 }
 
 template <typename T, size_t N>
-void Dequeue(Queue<T, N>& q) {
+T Dequeue(Queue<T, N>& q) {
     T x = q.data[q.head];
     if (q.head == q.data.size() - 1) {
         q.head = 0;
@@ -57,6 +79,324 @@ void Dequeue(Queue<T, N>& q) {
     return x;
 }
 
+// Bounded MPMC ring buffer after Vyukov. Every slot carries a sequence number that says whose
+// turn it is: a slot with seq == pos is free for the producer that claims position pos, and one
+// with seq == pos + 1 holds the value for the consumer that claims pos. Producers and consumers
+// claim positions with a CAS on tail and head respectively and then hand the slot over by
+// publishing its next sequence number, so they never wait for each other on a shared lock.
+// With SPSC = true the queue assumes one producer and one consumer, drops the sequence numbers
+// and CASes and works like a Lamport ring where each side caches the other side's index.
+template <typename T, size_t N, bool SPSC = false>
+class RingQueue {
+    static_assert(std::has_single_bit(N), "capacity must be a power of two");
+    static_assert(std::is_default_constructible_v<T> && std::is_move_assignable_v<T>);
+
+    static constexpr size_t CACHE_LINE = 64;
+    static constexpr size_t MASK = N - 1;
+
+    struct SeqSlot {
+        std::atomic<size_t> seq;
+        T value;
+    };
+    struct PlainSlot {
+        T value;
+    };
+    using Slot = std::conditional_t<SPSC, PlainSlot, SeqSlot>;
+
+    // head and tail are written by different sides, so each gets its own cache line together
+    // with the index that only that side reads
+    alignas(CACHE_LINE) std::atomic<size_t> tail {0};
+    size_t cachedHead = 0;
+    alignas(CACHE_LINE) std::atomic<size_t> head {0};
+    size_t cachedTail = 0;
+    alignas(CACHE_LINE) std::array<Slot, N> slots;
+
+    // the number of free positions from pos on, up to max, that producers may claim
+    size_t Writable(size_t pos, size_t max) {
+        if constexpr (SPSC) {
+            if (pos + max - cachedHead > N) {
+                cachedHead = head.load(std::memory_order_acquire);
+            }
+            return std::min(max, N - (pos - cachedHead));
+        } else {
+            size_t n = 0;
+            while (n < max && slots[(pos + n) & MASK].seq.load(std::memory_order_acquire) == pos + n) {
+                n++;
+            }
+            return n;
+        }
+    }
+
+    // the number of filled positions from pos on, up to max, that consumers may claim
+    size_t Readable(size_t pos, size_t max) {
+        if constexpr (SPSC) {
+            if (cachedTail - pos < max) {
+                cachedTail = tail.load(std::memory_order_acquire);
+            }
+            return std::min(max, cachedTail - pos);
+        } else {
+            size_t n = 0;
+            while (n < max && slots[(pos + n) & MASK].seq.load(std::memory_order_acquire) == pos + n + 1) {
+                n++;
+            }
+            return n;
+        }
+    }
+
+public:
+    RingQueue() {
+        if constexpr (!SPSC) {
+            for (size_t i = 0; i < N; i++) {
+                slots[i].seq.store(i, std::memory_order_relaxed);
+            }
+        }
+    }
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    static constexpr size_t Capacity() {
+        return N;
+    }
+
+    // enqueues the longest prefix of xs that fits and returns its length
+    size_t EnqueueBatch(std::span<const T> xs) {
+        size_t pos = tail.load(std::memory_order_relaxed);
+        size_t n;
+        if constexpr (SPSC) {
+            n = Writable(pos, xs.size());
+        } else {
+            do {
+                n = Writable(pos, xs.size());
+                if (n == 0) {
+                    // either full, or another producer moved tail and pos is stale
+                    size_t now = tail.load(std::memory_order_relaxed);
+                    if (now == pos) {
+                        return 0;
+                    }
+                    pos = now;
+                    continue;
+                }
+            } while (!tail.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed));
+        }
+        for (size_t i = 0; i < n; i++) {
+            slots[(pos + i) & MASK].value = xs[i];
+        }
+        if constexpr (SPSC) {
+            tail.store(pos + n, std::memory_order_release);
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                slots[(pos + i) & MASK].seq.store(pos + i + 1, std::memory_order_release);
+            }
+        }
+        return n;
+    }
+
+    // dequeues up to out.size() elements into out and returns how many
+    size_t DequeueBatch(std::span<T> out) {
+        size_t pos = head.load(std::memory_order_relaxed);
+        size_t n;
+        if constexpr (SPSC) {
+            n = Readable(pos, out.size());
+        } else {
+            do {
+                n = Readable(pos, out.size());
+                if (n == 0) {
+                    size_t now = head.load(std::memory_order_relaxed);
+                    if (now == pos) {
+                        return 0;
+                    }
+                    pos = now;
+                    continue;
+                }
+            } while (!head.compare_exchange_weak(pos, pos + n, std::memory_order_relaxed));
+        }
+        for (size_t i = 0; i < n; i++) {
+            out[i] = std::move(slots[(pos + i) & MASK].value);
+        }
+        if constexpr (SPSC) {
+            head.store(pos + n, std::memory_order_release);
+        } else {
+            for (size_t i = 0; i < n; i++) {
+                slots[(pos + i) & MASK].seq.store(pos + i + N, std::memory_order_release);
+            }
+        }
+        return n;
+    }
+
+    bool TryEnqueue(const T& x) {
+        return EnqueueBatch(std::span<const T>(&x, 1)) == 1;
+    }
+
+    bool TryDequeue(T& x) {
+        return DequeueBatch(std::span<T>(&x, 1)) == 1;
+    }
+};
+
+// the array queue above behind a mutex, as the baseline for the benchmark
+template <typename T, size_t N>
+class LockedQueue {
+    std::mutex m;
+    Queue<T, N + 1> q;
+
+public:
+    size_t EnqueueBatch(std::span<const T> xs) {
+        std::lock_guard lock (m);
+        size_t n = 0;
+        while (n < xs.size() && !QueueFull(q)) {
+            Enqueue(q, xs[n++]);
+        }
+        return n;
+    }
+
+    size_t DequeueBatch(std::span<T> out) {
+        std::lock_guard lock (m);
+        size_t n = 0;
+        while (n < out.size() && !QueueEmpty(q)) {
+            out[n++] = Dequeue(q);
+        }
+        return n;
+    }
+};
+
+// Moves messages from producers to consumers through Q in batches of the given size and returns
+// the rate in messages per second. A message carries its producer and sequence number, so every
+// consumer can check it receives each producer's messages in order, and the totals are checked
+// at the end.
+template <typename Q>
+double runPipeline(size_t producers, size_t consumers, size_t messages, size_t batch) {
+    auto q = std::make_unique<Q>();
+    const size_t perProducer = messages / producers;
+    const size_t total = perProducer * producers;
+    std::atomic<size_t> consumed {0};
+    std::atomic<uint64_t> checksum {0};
+    auto start = crn::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (size_t p = 0; p < producers; p++) {
+            workers.emplace_back([&, p] {
+                std::vector<uint64_t> buf (batch);
+                for (size_t i = 0; i < perProducer; ) {
+                    size_t n = std::min(batch, perProducer - i);
+                    for (size_t j = 0; j < n; j++) {
+                        buf[j] = (uint64_t {p} << 40) | (i + j);
+                    }
+                    std::span<const uint64_t> rest (buf.data(), n);
+                    while (!rest.empty()) {
+                        size_t sent = q->EnqueueBatch(rest);
+                        rest = rest.subspan(sent);
+                        if (sent == 0) {
+                            std::this_thread::yield();
+                        }
+                    }
+                    i += n;
+                }
+            });
+        }
+        for (size_t c = 0; c < consumers; c++) {
+            workers.emplace_back([&] {
+                std::vector<uint64_t> buf (batch);
+                std::vector<uint64_t> next (producers, 0);
+                uint64_t sum = 0;
+                while (consumed.load(std::memory_order_relaxed) < total) {
+                    size_t n = q->DequeueBatch(buf);
+                    if (n == 0) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    for (size_t j = 0; j < n; j++) {
+                        size_t p = buf[j] >> 40;
+                        uint64_t i = buf[j] & ((uint64_t {1} << 40) - 1);
+                        assert(p < producers && i >= next[p]);
+                        next[p] = i + 1;
+                        sum += buf[j];
+                    }
+                    consumed.fetch_add(n, std::memory_order_relaxed);
+                }
+                checksum.fetch_add(sum);
+            });
+        }
+    }
+    auto end = crn::steady_clock::now();
+    uint64_t expected = 0;
+    for (size_t p = 0; p < producers; p++) {
+        expected += (uint64_t {p} << 40) * perProducer + perProducer * (perProducer - 1) / 2;
+    }
+    assert(consumed == total && checksum == expected);
+    return static_cast<double>(total) / crn::duration<double>(end - start).count();
+}
+
 int main() {
+    Queue<int, 4> plain;
+    for (int i = 0; i < 10; i++) {
+        Enqueue(plain, i);
+        Enqueue(plain, i + 1);
+        assert(QueueFull(plain) == false);
+        assert(Dequeue(plain) == i && Dequeue(plain) == i + 1);
+        assert(QueueEmpty(plain));
+    }
+
+    auto check = [](auto& q) {
+        constexpr size_t N = std::remove_reference_t<decltype(q)>::Capacity();
+        int x;
+        assert(!q.TryDequeue(x));
+        for (int round = 0; round < 3; round++) {
+            for (int i = 0; i < static_cast<int>(N); i++) {
+                assert(q.TryEnqueue(i));
+            }
+            assert(!q.TryEnqueue(-1));
+            for (int i = 0; i < static_cast<int>(N); i++) {
+                assert(q.TryDequeue(x) && x == i);
+            }
+            assert(!q.TryDequeue(x));
+        }
+        std::vector<int> in (N + 3);
+        for (size_t i = 0; i < in.size(); i++) {
+            in[i] = static_cast<int>(i);
+        }
+        assert(q.EnqueueBatch(std::span<const int>(in).first(3)) == 3);
+        assert(q.EnqueueBatch(in) == N - 3);
+        std::vector<int> out (N + 3);
+        assert(q.DequeueBatch(out) == N);
+        for (size_t i = 0; i < N; i++) {
+            assert(out[i] == static_cast<int>(i < 3 ? i : i - 3));
+        }
+    };
+    auto mpmc = std::make_unique<RingQueue<int, 8>>();
+    auto spsc = std::make_unique<RingQueue<int, 8, true>>();
+    check(*mpmc);
+    check(*spsc);
 
+    constexpr size_t CAPACITY = 1024;
+    constexpr size_t MESSAGES = 4'000'000;
+    auto print = [](const char* name, size_t threads, double rate) {
+        std::cout << "  " << name << ", " << threads << " threads : " << rate / 1e6 << "M msgs/s\n";
+    };
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    {
+        // uncontended cost of a hand-off: one thread enqueues and dequeues in turn
+        auto q = std::make_unique<RingQueue<uint64_t, CAPACITY>>();
+        uint64_t x = 0;
+        uint64_t sum = 0;
+        auto start = crn::steady_clock::now();
+        for (uint64_t i = 0; i < MESSAGES; i++) {
+            q->TryEnqueue(i);
+            q->TryDequeue(x);
+            sum += x;
+        }
+        auto end = crn::steady_clock::now();
+        assert(sum == MESSAGES * (MESSAGES - 1) / 2);
+        print("MPMC ring", 1, MESSAGES / crn::duration<double>(end - start).count());
+    }
+    print("SPSC ring", 2, runPipeline<RingQueue<uint64_t, CAPACITY, true>>(1, 1, MESSAGES, 1));
+    print("SPSC ring, batch 64", 2, runPipeline<RingQueue<uint64_t, CAPACITY, true>>(1, 1, MESSAGES, 64));
+    for (size_t threads : {2, 4, 8, 16, 32}) {
+        size_t producers = threads / 2;
+        size_t consumers = threads - producers;
+        print("MPMC ring", threads, runPipeline<RingQueue<uint64_t, CAPACITY>>(producers, consumers, MESSAGES, 1));
+        print("MPMC ring, batch 64", threads,
+              runPipeline<RingQueue<uint64_t, CAPACITY>>(producers, consumers, MESSAGES, 64));
+        print("mutex + array queue", threads,
+              runPipeline<LockedQueue<uint64_t, CAPACITY>>(producers, consumers, MESSAGES, 1));
+    }
 }
\ No newline at end of file
@@ -1,6 +1,21 @@
 #include <cassert>
 #include <iostream>
 #include <forward_list>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <stack>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace crn = std::chrono;
 
 template <typename T>
 void Push(std::forward_list<T>& l, const T& key) {
@@ -11,8 +26,394 @@ template <typename T>
 T Pop(std::forward_list<T>& l) {
     T x = l.front();
     l.pop_front();
+    return x;
+}
+
+// A node pointer and a 16-bit version tag packed into one word, so that both can be replaced
+// by a single CAS. User space pointers on x86-64 and AArch64 fit in the low 48 bits.
+template <typename Node>
+class Tagged {
+    static constexpr unsigned TAG_SHIFT = 48;
+    static constexpr uintptr_t PTR_MASK = (uintptr_t {1} << TAG_SHIFT) - 1;
+    uintptr_t word = 0;
+
+public:
+    Tagged() = default;
+
+    Tagged(Node* ptr, uintptr_t tag) : word {reinterpret_cast<uintptr_t>(ptr) | (tag << TAG_SHIFT)} {
+        assert((reinterpret_cast<uintptr_t>(ptr) & ~PTR_MASK) == 0);
+    }
+
+    Node* ptr() const {
+        return reinterpret_cast<Node*>(word & PTR_MASK);
+    }
+
+    uintptr_t tag() const {
+        return word >> TAG_SHIFT;
+    }
+
+    // the next version of this word, pointing to ptr
+    Tagged next(Node* ptr) const {
+        return {ptr, (tag() + 1) & 0xFFFF};
+    }
+
+    bool operator==(const Tagged&) const = default;
+};
+
+// Hazard pointers (Michael, 2004) for nodes of type Node, shared by every structure that uses
+// them. Before dereferencing a shared node a thread publishes it in its hazard record and checks
+// that the node is still reachable. Removed nodes are retired instead of freed; once a thread has
+// retired enough of them it scans all hazard records and moves the nodes nobody protects to its
+// free list, from where they are reused by Allocate.
+template <typename Node>
+class HazardPointers {
+    static constexpr size_t MAX_THREADS = 128;
+    static constexpr size_t SCAN_THRESHOLD = 2 * MAX_THREADS;
+    static constexpr size_t FREE_LIMIT = 4 * SCAN_THRESHOLD;
+
+    struct alignas(64) Record {
+        std::atomic<Node*> hazard {nullptr};
+        std::atomic<bool> active {false};
+    };
+
+    // nodes still retired when their thread exited; adopted by the next scan of any thread
+    struct Orphans {
+        std::mutex m;
+        std::vector<Node*> nodes;
+
+        ~Orphans() {
+            for (auto node : nodes) {
+                delete node;
+            }
+        }
+    };
+
+    static inline std::array<Record, MAX_THREADS> records;
+    static inline Orphans orphans;
+
+    struct Local {
+        Record* record = nullptr;
+        std::vector<Node*> retired;
+        std::vector<Node*> free;
+
+        Local() {
+            for (auto& r : records) {
+                bool expected = false;
+                if (!r.active.load(std::memory_order_relaxed) && r.active.compare_exchange_strong(expected, true)) {
+                    record = &r;
+                    break;
+                }
+            }
+            if (!record) {
+                throw std::runtime_error("Too many threads for hazard pointers");
+            }
+        }
+
+        ~Local() {
+            record->hazard.store(nullptr);
+            Scan();
+            for (auto node : free) {
+                delete node;
+            }
+            if (!retired.empty()) {
+                std::lock_guard lock (orphans.m);
+                orphans.nodes.insert(orphans.nodes.end(), retired.begin(), retired.end());
+            }
+            record->active.store(false, std::memory_order_release);
+        }
+
+        void Scan() {
+            {
+                std::lock_guard lock (orphans.m);
+                retired.insert(retired.end(), orphans.nodes.begin(), orphans.nodes.end());
+                orphans.nodes.clear();
+            }
+            std::vector<Node*> hazards;
+            for (const auto& r : records) {
+                if (r.active.load(std::memory_order_acquire)) {
+                    if (auto p = r.hazard.load()) {
+                        hazards.push_back(p);
+                    }
+                }
+            }
+            std::sort(hazards.begin(), hazards.end());
+            auto protectedEnd = std::partition(retired.begin(), retired.end(), [&](Node* node) {
+                return std::binary_search(hazards.begin(), hazards.end(), node);
+            });
+            for (auto it = protectedEnd; it != retired.end(); ++it) {
+                if (free.size() < FREE_LIMIT) {
+                    free.push_back(*it);
+                } else {
+                    delete *it;
+                }
+            }
+            retired.erase(protectedEnd, retired.end());
+        }
+    };
+
+    static Local& local() {
+        thread_local Local l;
+        return l;
+    }
+
+public:
+    static Node* Allocate() {
+        auto& l = local();
+        if (l.free.empty()) {
+            return new Node {};
+        }
+        Node* node = l.free.back();
+        l.free.pop_back();
+        return node;
+    }
+
+    // the store must be ordered before the caller's re-validation load, hence seq_cst
+    static void Protect(Node* node) {
+        local().record->hazard.store(node);
+    }
+
+    static void Clear() {
+        local().record->hazard.store(nullptr, std::memory_order_release);
+    }
+
+    static void Retire(Node* node) {
+        auto& l = local();
+        l.retired.push_back(node);
+        if (l.retired.size() >= SCAN_THRESHOLD) {
+            l.Scan();
+        }
+    }
+};
+
+// Treiber's lock-free stack. The top pointer is tagged so that a CAS never succeeds against a
+// top that was popped and pushed again in between, and popped nodes are recycled only once no
+// thread holds a hazard pointer to them. When a CAS on top fails because of contention, the
+// thread visits a random slot of an elimination array (Hendler, Shavit and Yerushalmi): a push
+// leaves its node there for a short while, and a pop that finds it takes it, so the two cancel
+// out without touching top.
+template <typename T>
+class LockFreeStack {
+    struct Node {
+        T key;
+        Node* next = nullptr;
+    };
+    using Hazards = HazardPointers<Node>;
+
+    static constexpr size_t ELIMINATION_SLOTS = 16;
+    static constexpr int ELIMINATION_SPINS = 128;
+
+    struct alignas(64) Exchanger {
+        std::atomic<Tagged<Node>> offer;
+    };
+
+    alignas(64) std::atomic<Tagged<Node>> top;
+    std::array<Exchanger, ELIMINATION_SLOTS> exchangers;
+    bool eliminate;
+
+    static_assert(std::atomic<Tagged<Node>>::is_always_lock_free);
+
+    static Exchanger& randomExchanger(std::array<Exchanger, ELIMINATION_SLOTS>& exchangers) {
+        thread_local std::minstd_rand gen (std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        return exchangers[gen() % ELIMINATION_SLOTS];
+    }
+
+    bool EliminatePush(Node* node) {
+        auto& slot = randomExchanger(exchangers).offer;
+        auto empty = slot.load(std::memory_order_relaxed);
+        if (empty.ptr()) {
+            return false;
+        }
+        auto mine = empty.next(node);
+        if (!slot.compare_exchange_strong(empty, mine, std::memory_order_release, std::memory_order_relaxed)) {
+            return false;
+        }
+        for (int i = 0; i < ELIMINATION_SPINS; i++) {
+            if (slot.load(std::memory_order_relaxed) != mine) {
+                return true;
+            }
+        }
+        // withdraw the offer, unless a pop has taken it meanwhile
+        return !slot.compare_exchange_strong(mine, mine.next(nullptr), std::memory_order_relaxed);
+    }
+
+    Node* EliminatePop() {
+        auto& slot = randomExchanger(exchangers).offer;
+        auto offer = slot.load(std::memory_order_relaxed);
+        if (offer.ptr() && slot.compare_exchange_strong(offer, offer.next(nullptr), std::memory_order_acquire,
+                                                        std::memory_order_relaxed)) {
+            return offer.ptr();
+        }
+        return nullptr;
+    }
+
+public:
+    explicit LockFreeStack(bool eliminate = true) : eliminate {eliminate} {}
+
+    LockFreeStack(const LockFreeStack&) = delete;
+    LockFreeStack& operator=(const LockFreeStack&) = delete;
+
+    ~LockFreeStack() {
+        Node* node = top.load().ptr();
+        while (node) {
+            delete std::exchange(node, node->next);
+        }
+    }
+
+    void Push(const T& key) {
+        Node* node = Hazards::Allocate();
+        node->key = key;
+        auto old = top.load(std::memory_order_relaxed);
+        while (true) {
+            node->next = old.ptr();
+            if (top.compare_exchange_weak(old, old.next(node), std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+            if (eliminate && EliminatePush(node)) {
+                return;
+            }
+            old = top.load(std::memory_order_relaxed);
+        }
+    }
+
+    std::optional<T> Pop() {
+        while (true) {
+            auto old = top.load(std::memory_order_acquire);
+            if (!old.ptr()) {
+                return std::nullopt;
+            }
+            Hazards::Protect(old.ptr());
+            if (top.load() != old) {
+                continue;
+            }
+            Node* node = old.ptr();
+            if (top.compare_exchange_strong(old, old.next(node->next), std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+                Hazards::Clear();
+                T key = std::move(node->key);
+                Hazards::Retire(node);
+                return key;
+            }
+            Hazards::Clear();
+            if (eliminate) {
+                if (Node* given = EliminatePop()) {
+                    T key = std::move(given->key);
+                    Hazards::Retire(given);
+                    return key;
+                }
+            }
+        }
+    }
+};
+
+template <typename T>
+class LockedStack {
+    std::mutex m;
+    std::stack<T> s;
+
+public:
+    void Push(const T& key) {
+        std::lock_guard lock (m);
+        s.push(key);
+    }
+
+    std::optional<T> Pop() {
+        std::lock_guard lock (m);
+        if (s.empty()) {
+            return std::nullopt;
+        }
+        T key = s.top();
+        s.pop();
+        return key;
+    }
+};
+
+// Every thread pushes its own range of values and pops in between, so nodes are recycled all the
+// time while other threads still hold stale tops. An ABA slip would pop a value twice or lose
+// one; the counts catch both.
+void stressTest(size_t threads, size_t perThread, bool eliminate) {
+    LockFreeStack<uint32_t> stack (eliminate);
+    std::vector<std::atomic<uint8_t>> popped (threads * perThread);
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                std::minstd_rand gen (static_cast<unsigned>(t));
+                size_t next = t * perThread;
+                size_t end = next + perThread;
+                while (next < end) {
+                    size_t burst = gen() % 8 + 1;
+                    for (size_t i = 0; i < burst && next < end; i++) {
+                        stack.Push(static_cast<uint32_t>(next++));
+                    }
+                    for (size_t i = gen() % 8 + 1; i > 0; i--) {
+                        if (auto x = stack.Pop()) {
+                            popped[*x].fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                }
+            });
+        }
+    }
+    while (auto x = stack.Pop()) {
+        popped[*x].fetch_add(1, std::memory_order_relaxed);
+    }
+    for (const auto& count : popped) {
+        assert(count.load() == 1);
+    }
+}
+
+// each thread pushes and pops in turn on a stack that starts with some elements
+template <typename Stack>
+double throughput(size_t threads, size_t operations, Stack& stack) {
+    for (int i = 0; i < 1024; i++) {
+        stack.Push(i);
+    }
+    auto start = crn::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&] {
+                for (size_t i = 0; i < operations / threads / 2; i++) {
+                    stack.Push(static_cast<int>(i));
+                    [[maybe_unused]] auto x = stack.Pop();
+                    assert(x);
+                }
+            });
+        }
+    }
+    auto end = crn::steady_clock::now();
+    return static_cast<double>(operations) / crn::duration<double>(end - start).count();
 }
 
 int main() {
+    std::forward_list<int> l;
+    Push(l, 1);
+    Push(l, 2);
+    assert(Pop(l) == 2 && Pop(l) == 1 && l.empty());
+
+    LockFreeStack<int> s;
+    assert(!s.Pop());
+    for (int i = 0; i < 1000; i++) {
+        s.Push(i);
+    }
+    for (int i = 999; i >= 0; i--) {
+        assert(s.Pop() == i);
+    }
+    assert(!s.Pop());
+
+    for (size_t threads : {2, 4, 8, 16}) {
+        stressTest(threads, 200'000, false);
+        stressTest(threads, 200'000, true);
+    }
 
+    constexpr size_t OPERATIONS = 4'000'000;
+    std::cout << "hardware threads: " << std::thread::hardware_concurrency() << '\n';
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        LockedStack<int> locked;
+        LockFreeStack<int> treiber (false);
+        LockFreeStack<int> elimination (true);
+        std::cout << threads << " threads, Mops/s: mutex + std::stack " << throughput(threads, OPERATIONS, locked) / 1e6
+                  << ", Treiber " << throughput(threads, OPERATIONS, treiber) / 1e6
+                  << ", Treiber + elimination " << throughput(threads, OPERATIONS, elimination) / 1e6 << '\n';
+    }
 }
\ No newline at end of file
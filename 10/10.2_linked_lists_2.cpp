@@ -2,6 +2,25 @@
 #include <iostream>
 #include <utility>
 #include <memory>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAS_AVX2_KERNELS 1
+#include <immintrin.h>
+#define AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace crn = std::chrono;
 
 template <typename T>
 struct ListNode {
@@ -47,6 +66,331 @@ public:
     }
 };
 
+template <typename T>
+concept SimdKey = std::same_as<T, std::int32_t> || std::same_as<T, std::int64_t>;
+
+#ifdef HAS_AVX2_KERNELS
+
+// equality search over one 256-bit register of T; the masked load never touches keys past n
+template <typename T>
+struct Avx2Find;
+
+template <>
+struct Avx2Find<std::int32_t> {
+    static constexpr size_t lanes = 8;
+    AVX2 static unsigned matches(const std::int32_t* p, size_t n, std::int32_t k) {
+        __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        __m256i v = _mm256_maskload_epi32(reinterpret_cast<const int*>(p), valid);
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi32(v, _mm256_set1_epi32(k)), valid);
+        return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+    }
+};
+
+template <>
+struct Avx2Find<std::int64_t> {
+    static constexpr size_t lanes = 4;
+    AVX2 static unsigned matches(const std::int64_t* p, size_t n, std::int64_t k) {
+        __m256i valid = _mm256_cmpgt_epi64(_mm256_set1_epi64x(static_cast<long long>(n)), _mm256_setr_epi64x(0, 1, 2, 3));
+        __m256i v = _mm256_maskload_epi64(reinterpret_cast<const long long*>(p), valid);
+        __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi64(v, _mm256_set1_epi64x(k)), valid);
+        return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+    }
+};
+
+template <SimdKey T>
+AVX2 size_t findAvx2(const T* keys, size_t count, T k) {
+    using S = Avx2Find<T>;
+    for (size_t i = 0; i < count; i += S::lanes) {
+        if (unsigned bits = S::matches(keys + i, std::min(S::lanes, count - i), k)) {
+            return i + static_cast<size_t>(std::countr_zero(bits));
+        }
+    }
+    return count;
+}
+
+#endif
+
+bool hasAvx2() {
+#ifdef HAS_AVX2_KERNELS
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+#else
+    return false;
+#endif
+}
+
+// the index of the first key equal to k, or count if there is none
+template <typename T>
+size_t findInNode(const T* keys, size_t count, const T& k) {
+#ifdef HAS_AVX2_KERNELS
+    if constexpr (SimdKey<T>) {
+        if (hasAvx2()) {
+            return findAvx2(keys, count, k);
+        }
+    }
+#endif
+    return static_cast<size_t>(std::find(keys, keys + count, k) - keys);
+}
+
+// Unrolled doubly linked list: every node fills NodeBytes (one or two cache lines) and holds as
+// many keys as fit next to its links, so a scan touches one node per several keys instead of one
+// per key, and a search compares a whole node with a few vector instructions. A full node is
+// split in half on insertion; a node that drops below half full after a deletion is merged
+// with a neighbour, or takes keys from it when both together would not fit, so all nodes but
+// one stay at least half full, and nodes filled by appending at the back are full.
+//
+// Iterator stability: ListInsert and ListDelete only move keys within the node they change and,
+// on a split, merge or borrow, the neighbour involved. Iterators into those nodes are invalidated,
+// iterators into every other node stay valid.
+template <typename T, size_t NodeBytes = 64>
+class UnrolledList {
+    static constexpr size_t CAPACITY = (NodeBytes - 2 * sizeof(void*) - sizeof(std::uint32_t)) / sizeof(T);
+    static_assert(CAPACITY >= 4, "a node must hold at least four keys");
+
+    struct alignas(NodeBytes) Node {
+        Node* prev = nullptr;
+        Node* next = nullptr;
+        std::uint32_t count = 0;
+        std::array<T, CAPACITY> keys {};
+    };
+    static_assert(sizeof(Node) == NodeBytes);
+
+    Node nil;
+    size_t n = 0;
+
+    Node* NewNodeAfter(Node* x) {
+        Node* y = new Node;
+        y->prev = x;
+        y->next = x->next;
+        x->next->prev = y;
+        x->next = y;
+        return y;
+    }
+
+    void Unlink(Node* x) {
+        x->prev->next = x->next;
+        x->next->prev = x->prev;
+        delete x;
+    }
+
+    // moves the keys of b to the end of a and deletes b
+    void Merge(Node* a, Node* b) {
+        std::move(b->keys.begin(), b->keys.begin() + b->count, a->keys.begin() + a->count);
+        a->count += b->count;
+        Unlink(b);
+    }
+
+public:
+    class iterator {
+        friend class UnrolledList;
+        Node* node = nullptr;
+        size_t index = 0;
+
+        iterator(Node* node, size_t index) : node {node}, index {index} {}
+
+        // the position past the last key of a node is the first key of the next one
+        iterator& normalize() {
+            if (index == node->count && node->count != 0) {
+                node = node->next;
+                index = 0;
+            }
+            return *this;
+        }
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = T*;
+        using reference = T&;
+
+        iterator() = default;
+
+        T& operator*() const {
+            return node->keys[index];
+        }
+
+        T* operator->() const {
+            return &node->keys[index];
+        }
+
+        iterator& operator++() {
+            index++;
+            return normalize();
+        }
+
+        iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        iterator& operator--() {
+            if (index == 0) {
+                node = node->prev;
+                index = node->count;
+            }
+            index--;
+            return *this;
+        }
+
+        iterator operator--(int) {
+            auto old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const iterator&) const = default;
+    };
+
+    UnrolledList() {
+        nil.prev = &nil;
+        nil.next = &nil;
+    }
+
+    UnrolledList(const UnrolledList&) = delete;
+    UnrolledList& operator=(const UnrolledList&) = delete;
+
+    ~UnrolledList() {
+        while (nil.next != &nil) {
+            Unlink(nil.next);
+        }
+    }
+
+    static constexpr size_t NodeCapacity() {
+        return CAPACITY;
+    }
+
+    size_t size() const {
+        return n;
+    }
+
+    bool empty() const {
+        return n == 0;
+    }
+
+    iterator begin() {
+        return {nil.next, 0};
+    }
+
+    iterator end() {
+        return {&nil, 0};
+    }
+
+    // inserts k before pos and returns an iterator to it
+    iterator ListInsert(iterator pos, const T& k) {
+        Node* x = pos.node;
+        size_t i = pos.index;
+        if (x == &nil || (i == 0 && x->prev != &nil && x->prev->count < CAPACITY)) {
+            // appending to the node before pos saves a shift, and at the end there is no other choice
+            x = x->prev;
+            if (x == &nil) {
+                x = NewNodeAfter(&nil);
+            }
+            i = x->count;
+        }
+        if (x->count == CAPACITY && i == CAPACITY && x->next == &nil) {
+            // appending at the back starts a new node, so that a list built by PushBack is full
+            x = NewNodeAfter(x);
+            i = 0;
+        } else if (x->count == CAPACITY) {
+            Node* y = NewNodeAfter(x);
+            size_t half = CAPACITY / 2;
+            std::move(x->keys.begin() + half, x->keys.end(), y->keys.begin());
+            y->count = static_cast<std::uint32_t>(CAPACITY - half);
+            x->count = static_cast<std::uint32_t>(half);
+            if (i > half) {
+                x = y;
+                i -= half;
+            }
+        }
+        std::move_backward(x->keys.begin() + i, x->keys.begin() + x->count, x->keys.begin() + x->count + 1);
+        x->keys[i] = k;
+        x->count++;
+        n++;
+        return {x, i};
+    }
+
+    void PushBack(const T& k) {
+        ListInsert(end(), k);
+    }
+
+    // deletes the key at pos and returns an iterator to the key after it
+    iterator ListDelete(iterator pos) {
+        Node* x = pos.node;
+        size_t i = pos.index;
+        assert(x != &nil && i < x->count);
+        std::move(x->keys.begin() + i + 1, x->keys.begin() + x->count, x->keys.begin() + i);
+        x->count--;
+        n--;
+        if (x->count == 0) {
+            Node* next = x->next;
+            Unlink(x);
+            return {next, 0};
+        }
+        if (x->count >= CAPACITY / 2) {
+            return iterator(x, i).normalize();
+        }
+        if (Node* y = x->next; y != &nil) {
+            if (x->count + y->count <= CAPACITY) {
+                Merge(x, y);
+            } else {
+                // take keys from the front of y until both are about equally full
+                size_t d = (y->count - x->count) / 2;
+                std::move(y->keys.begin(), y->keys.begin() + d, x->keys.begin() + x->count);
+                std::move(y->keys.begin() + d, y->keys.begin() + y->count, y->keys.begin());
+                x->count += static_cast<std::uint32_t>(d);
+                y->count -= static_cast<std::uint32_t>(d);
+            }
+            return iterator(x, i).normalize();
+        }
+        if (Node* w = x->prev; w != &nil) {
+            if (w->count + x->count <= CAPACITY) {
+                size_t offset = w->count;
+                Merge(w, x);
+                return iterator(w, offset + i).normalize();
+            }
+            // take keys from the back of w
+            size_t d = (w->count - x->count) / 2;
+            std::move_backward(x->keys.begin(), x->keys.begin() + x->count, x->keys.begin() + x->count + d);
+            std::move(w->keys.begin() + w->count - d, w->keys.begin() + w->count, x->keys.begin());
+            w->count -= static_cast<std::uint32_t>(d);
+            x->count += static_cast<std::uint32_t>(d);
+            return iterator(x, i + d).normalize();
+        }
+        return iterator(x, i).normalize();
+    }
+
+    iterator ListSearch(const T& k) {
+        for (Node* x = nil.next; x != &nil; x = x->next) {
+            size_t i = findInNode(x->keys.data(), x->count, k);
+            if (i < x->count) {
+                return {x, i};
+            }
+        }
+        return end();
+    }
+
+    // checks the links, the counts and the occupancy invariant
+    void Validate() const {
+        size_t total = 0;
+        size_t underfull = 0;
+        for (const Node* x = nil.next; x != &nil; x = x->next) {
+            assert(x->next->prev == x && x->count > 0 && x->count <= CAPACITY);
+            underfull += x->count < CAPACITY / 2;
+            total += x->count;
+        }
+        assert(total == n && underfull <= 1);
+    }
+};
+
+template <typename F>
+long long millis(F&& f) {
+    auto start = crn::steady_clock::now();
+    f();
+    return crn::duration_cast<crn::milliseconds>(crn::steady_clock::now() - start).count();
+}
+
 int main() {
     auto p1 = std::make_shared<ListNode<int>>(1);
     auto p2 = std::make_shared<ListNode<int>>(2);
@@ -59,4 +403,117 @@ int main() {
     l.ListDelete(p2);
     assert(!l.ListSearch(2));
 
+    // random inserts and deletes against std::list
+    std::mt19937 gen (1);
+    {
+        UnrolledList<std::int32_t> u;
+        std::list<std::int32_t> ref;
+        for (int step = 0; step < 200'000; step++) {
+            size_t pos = ref.empty() ? 0 : gen() % (ref.size() + 1);
+            auto it = std::next(u.begin(), static_cast<std::ptrdiff_t>(pos));
+            auto rit = std::next(ref.begin(), static_cast<std::ptrdiff_t>(pos));
+            if (gen() % 3 != 0 || pos == ref.size()) {
+                auto k = static_cast<std::int32_t>(gen() % 1000);
+                assert(*u.ListInsert(it, k) == *ref.insert(rit, k));
+            } else {
+                auto next = u.ListDelete(it);
+                auto rnext = ref.erase(rit);
+                assert((next == u.end()) == (rnext == ref.end()) && (next == u.end() || *next == *rnext));
+            }
+            if (step % 1000 == 0) {
+                u.Validate();
+                assert(std::equal(u.begin(), u.end(), ref.begin(), ref.end()));
+                assert(std::equal(std::make_reverse_iterator(u.end()), std::make_reverse_iterator(u.begin()),
+                                  ref.rbegin(), ref.rend()));
+            }
+            if (ref.size() > 3'000) {
+                while (ref.size() > 100) {
+                    u.ListDelete(u.begin());
+                    ref.pop_front();
+                }
+            }
+        }
+        for (std::int32_t k = -1; k < 1000; k += 7) {
+            auto it = u.ListSearch(k);
+            auto rit = std::find(ref.begin(), ref.end(), k);
+            assert((it == u.end()) == (rit == ref.end()));
+            assert(it == u.end() || (*it == k && std::distance(u.begin(), it) == std::distance(ref.begin(), rit)));
+        }
+    }
+
+    // iterators into nodes a change does not touch stay valid
+    {
+        UnrolledList<std::int64_t, 128> u;
+        for (std::int64_t i = 0; i < 1000; i++) {
+            u.PushBack(i);
+        }
+        auto far = u.ListSearch(900);
+        auto mid = u.ListSearch(100);
+        for (int i = 0; i < 500; i++) {
+            mid = u.ListInsert(mid, -i);
+        }
+        for (int i = 0; i < 300; i++) {
+            mid = u.ListDelete(mid);
+        }
+        assert(*far == 900 && *std::next(far) == 901 && *std::prev(far) == 899);
+        u.Validate();
+    }
+
+    constexpr size_t N = 1'000'000;
+    std::vector<std::int32_t> keys (N);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), gen);
+    UnrolledList<std::int32_t, 64> u64;
+    UnrolledList<std::int32_t, 128> u128;
+    std::list<std::int32_t> sl;
+    // the nodes of a long-lived std::list end up scattered over the heap; interleaving its
+    // allocations with others of the same size imitates that
+    std::vector<std::unique_ptr<std::array<std::int32_t, 4>>> noise;
+    for (auto k : keys) {
+        u64.PushBack(k);
+        u128.PushBack(k);
+        sl.push_back(k);
+        noise.push_back(std::make_unique<std::array<std::int32_t, 4>>());
+    }
+    std::vector<std::int32_t> v (keys);
+
+    std::cout << N << " keys; node capacities " << u64.NodeCapacity() << " (64 B) and " << u128.NodeCapacity()
+              << " (128 B)\n";
+    long long sums[4] {};
+    std::cout << "scan: UnrolledList<64> " << millis([&] { for (int r = 0; r < 10; r++) sums[0] += std::accumulate(u64.begin(), u64.end(), 0LL); })
+              << "ms, UnrolledList<128> " << millis([&] { for (int r = 0; r < 10; r++) sums[1] += std::accumulate(u128.begin(), u128.end(), 0LL); })
+              << "ms, std::list " << millis([&] { for (int r = 0; r < 10; r++) sums[2] += std::accumulate(sl.begin(), sl.end(), 0LL); })
+              << "ms, std::vector " << millis([&] { for (int r = 0; r < 10; r++) sums[3] += std::accumulate(v.begin(), v.end(), 0LL); })
+              << "ms\n";
+    assert(sums[0] == sums[1] && sums[1] == sums[2] && sums[2] == sums[3]);
+
+    std::vector<std::int32_t> targets;
+    for (int i = 0; i < 50; i++) {
+        targets.push_back(static_cast<std::int32_t>(gen() % (2 * N)));
+    }
+    size_t found[4] {};
+    std::cout << "search: UnrolledList<64> " << millis([&] { for (auto k : targets) found[0] += u64.ListSearch(k) != u64.end(); })
+              << "ms, UnrolledList<128> " << millis([&] { for (auto k : targets) found[1] += u128.ListSearch(k) != u128.end(); })
+              << "ms, std::list " << millis([&] { for (auto k : targets) found[2] += std::find(sl.begin(), sl.end(), k) != sl.end(); })
+              << "ms, std::vector " << millis([&] { for (auto k : targets) found[3] += std::find(v.begin(), v.end(), k) != v.end(); })
+              << "ms\n";
+    assert(found[0] == found[1] && found[1] == found[2] && found[2] == found[3]);
+
+    // repeated inserts at a position in the middle of the container, in ns per insert; the vector
+    // gets fewer since each of its inserts moves half a million keys
+    constexpr size_t INSERTS = 200'000;
+    constexpr size_t VECTOR_INSERTS = 2'000;
+    auto it64 = std::next(u64.begin(), N / 2);
+    auto it128 = std::next(u128.begin(), N / 2);
+    auto sit = std::next(sl.begin(), N / 2);
+    auto vit = v.begin() + N / 2;
+    std::cout << "mid-list insert: UnrolledList<64> " << millis([&] { for (size_t i = 0; i < INSERTS; i++) it64 = u64.ListInsert(it64, static_cast<std::int32_t>(i)); }) * 1'000'000 / INSERTS
+              << "ns, UnrolledList<128> " << millis([&] { for (size_t i = 0; i < INSERTS; i++) it128 = u128.ListInsert(it128, static_cast<std::int32_t>(i)); }) * 1'000'000 / INSERTS
+              << "ns, std::list " << millis([&] { for (size_t i = 0; i < INSERTS; i++) sit = sl.insert(sit, static_cast<std::int32_t>(i)); }) * 1'000'000 / INSERTS
+              << "ns, std::vector " << millis([&] { for (size_t i = 0; i < VECTOR_INSERTS; i++) vit = v.insert(vit, static_cast<std::int32_t>(i)); }) * 1'000'000 / VECTOR_INSERTS
+              << "ns\n";
+    assert(*std::next(u64.begin(), N / 2) == INSERTS - 1 && *std::next(sl.begin(), N / 2) == INSERTS - 1);
+    u64.Validate();
+    u128.Validate();
+
 }
\ No newline at end of file
@@ -2,7 +2,24 @@
 #include <cassert>
 #include <iostream>
 #include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <numeric>
+#include <random>
 #include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace crn = std::chrono;
 
 template <typename T, size_t N>
 struct GC {
@@ -38,6 +55,446 @@ struct GC {
 };
 
 
+// GC above, grown into a general allocator of fixed-size blocks. Blocks come from slabs that are
+// added as the pool grows, and a free block holds the link to the next free one, as next[x] does
+// for a free object of GC. Each thread keeps its own free list per pool and exchanges blocks with
+// the pool's shared list in batches, so most allocations and frees take no lock.
+class BlockPool {
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Cache;
+
+    struct Depot {
+        size_t blockSize;
+        size_t blockAlign;
+        size_t slabBlocks;
+        std::mutex m;
+        std::vector<std::byte*> slabs;
+        FreeBlock* free = nullptr;
+        std::vector<Cache*> caches;
+        std::atomic<bool> alive {true};
+
+        Depot(size_t blockSize, size_t blockAlign, size_t slabBlocks)
+            : blockSize {blockSize}, blockAlign {blockAlign}, slabBlocks {slabBlocks} {}
+
+        ~Depot() {
+            for (auto slab : slabs) {
+                ::operator delete(slab, std::align_val_t {blockAlign});
+            }
+        }
+
+        size_t SlabBytes() const {
+            return blockSize * slabBlocks;
+        }
+
+        // called with m held
+        void Grow() {
+            auto slab = static_cast<std::byte*>(::operator new(SlabBytes(), std::align_val_t {blockAlign}));
+            slabs.push_back(slab);
+            for (size_t i = slabBlocks; i > 0; i--) {
+                auto block = reinterpret_cast<FreeBlock*>(slab + (i - 1) * blockSize);
+                block->next = free;
+                free = block;
+            }
+        }
+    };
+
+    // the free blocks one thread holds for one pool; they go back to the depot when the thread
+    // exits, which may be after the pool is gone, hence the shared ownership of the depot
+    struct Cache {
+        std::shared_ptr<Depot> depot;
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+
+        explicit Cache(std::shared_ptr<Depot> d) : depot {std::move(d)} {
+            std::lock_guard lock (depot->m);
+            depot->caches.push_back(this);
+        }
+
+        ~Cache() {
+            std::lock_guard lock (depot->m);
+            Drain();
+            std::erase(depot->caches, this);
+        }
+
+        // called with depot->m held
+        void Drain() {
+            while (head) {
+                auto block = std::exchange(head, head->next);
+                block->next = depot->free;
+                depot->free = block;
+            }
+            count = 0;
+        }
+    };
+
+    static constexpr size_t BATCH = 32;
+
+    std::shared_ptr<Depot> depot;
+
+    Cache& LocalCache() {
+        thread_local std::vector<std::pair<Depot*, std::unique_ptr<Cache>>> caches;
+        for (auto& [d, cache] : caches) {
+            if (d == depot.get()) {
+                return *cache;
+            }
+        }
+        // caches of destroyed pools only hold their depot alive, so drop them here
+        std::erase_if(caches, [](const auto& entry) { return !entry.first->alive; });
+        caches.emplace_back(depot.get(), std::make_unique<Cache>(depot));
+        return *caches.back().second;
+    }
+
+public:
+    BlockPool(size_t blockSize, size_t blockAlign = alignof(std::max_align_t), size_t slabBlocks = 1024) {
+        assert(std::has_single_bit(blockAlign) && slabBlocks > 0);
+        blockAlign = std::max(blockAlign, alignof(FreeBlock));
+        blockSize = std::max(blockSize, sizeof(FreeBlock));
+        blockSize = (blockSize + blockAlign - 1) / blockAlign * blockAlign;
+        depot = std::make_shared<Depot>(blockSize, blockAlign, slabBlocks);
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    ~BlockPool() {
+        depot->alive = false;
+    }
+
+    size_t BlockSize() const {
+        return depot->blockSize;
+    }
+
+    size_t SlabCount() {
+        std::lock_guard lock (depot->m);
+        return depot->slabs.size();
+    }
+
+    void* Allocate() {
+        auto& cache = LocalCache();
+        if (!cache.head) {
+            std::lock_guard lock (depot->m);
+            while (cache.count < BATCH) {
+                if (!depot->free) {
+                    depot->Grow();
+                }
+                auto block = std::exchange(depot->free, depot->free->next);
+                block->next = cache.head;
+                cache.head = block;
+                cache.count++;
+            }
+        }
+        cache.count--;
+        return std::exchange(cache.head, cache.head->next);
+    }
+
+    void Deallocate(void* p) {
+        auto& cache = LocalCache();
+        auto block = static_cast<FreeBlock*>(p);
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.count >= 2 * BATCH) {
+            std::lock_guard lock (depot->m);
+            for (size_t i = 0; i < BATCH; i++) {
+                auto returned = std::exchange(cache.head, cache.head->next);
+                returned->next = depot->free;
+                depot->free = returned;
+            }
+            cache.count -= BATCH;
+        }
+    }
+
+    // Moves the live blocks out of the emptiest slabs into the holes of the fullest ones and
+    // releases the slabs that end up empty, like Compactify of 10.3-5 does for GC. relocate(from,
+    // to) must move the object at from into the free block to and update every pointer to it.
+    // No other thread may use the pool meanwhile. Returns the number of slabs released.
+    template <typename F>
+    size_t Compact(F&& relocate) {
+        std::lock_guard lock (depot->m);
+        for (auto cache : depot->caches) {
+            cache->Drain();
+        }
+        auto& slabs = depot->slabs;
+        const size_t blocks = depot->slabBlocks;
+        std::sort(slabs.begin(), slabs.end());
+        std::vector<std::vector<bool>> isFree (slabs.size(), std::vector<bool>(blocks, false));
+        std::vector<size_t> live (slabs.size(), blocks);
+        for (auto block = depot->free; block; block = block->next) {
+            auto addr = reinterpret_cast<std::byte*>(block);
+            size_t s = std::upper_bound(slabs.begin(), slabs.end(), addr) - slabs.begin() - 1;
+            isFree[s][(addr - slabs[s]) / depot->blockSize] = true;
+            live[s]--;
+        }
+        size_t totalLive = std::accumulate(live.begin(), live.end(), size_t {0});
+        size_t keep = (totalLive + blocks - 1) / blocks;
+        std::vector<size_t> order (slabs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return live[a] > live[b]; });
+
+        std::vector<std::byte*> holes;
+        for (size_t i = 0; i < keep; i++) {
+            size_t s = order[i];
+            for (size_t b = 0; b < blocks; b++) {
+                if (isFree[s][b]) {
+                    holes.push_back(slabs[s] + b * depot->blockSize);
+                }
+            }
+        }
+        for (size_t i = keep; i < order.size(); i++) {
+            size_t s = order[i];
+            for (size_t b = 0; b < blocks && live[s] > 0; b++) {
+                if (!isFree[s][b]) {
+                    assert(!holes.empty());
+                    relocate(static_cast<void*>(slabs[s] + b * depot->blockSize), static_cast<void*>(holes.back()));
+                    holes.pop_back();
+                    live[s]--;
+                }
+            }
+        }
+
+        std::vector<std::byte*> kept;
+        for (size_t i = 0; i < order.size(); i++) {
+            if (i < keep) {
+                kept.push_back(slabs[order[i]]);
+            } else {
+                ::operator delete(slabs[order[i]], std::align_val_t {depot->blockAlign});
+            }
+        }
+        size_t released = slabs.size() - kept.size();
+        slabs = std::move(kept);
+        depot->free = nullptr;
+        for (auto hole : holes) {
+            auto block = reinterpret_cast<FreeBlock*>(hole);
+            block->next = depot->free;
+            depot->free = block;
+        }
+        return released;
+    }
+};
+
+// typed objects on a BlockPool, with the interface of GC
+template <typename T>
+class ObjectPool {
+    BlockPool pool;
+
+public:
+    explicit ObjectPool(size_t slabObjects = 1024) : pool {sizeof(T), alignof(T), slabObjects} {}
+
+    template <typename... Args>
+    T* AllocateObject(Args&&... args) {
+        void* p = pool.Allocate();
+        try {
+            return new (p) T(std::forward<Args>(args)...);
+        } catch (...) {
+            pool.Deallocate(p);
+            throw;
+        }
+    }
+
+    void FreeObject(T* x) {
+        x->~T();
+        pool.Deallocate(x);
+    }
+
+    // relocate(from, to) must move *from to the raw storage to and fix the pointers to it
+    template <typename F>
+    size_t Compact(F&& relocate) {
+        return pool.Compact([&](void* from, void* to) { relocate(static_cast<T*>(from), static_cast<T*>(to)); });
+    }
+
+    size_t SlabCount() {
+        return pool.SlabCount();
+    }
+};
+
+// A memory resource that serves requests of up to MAX_POOLED bytes from BlockPools of
+// power-of-two size classes and everything else from upstream, so the standard node-based
+// containers (std::pmr::list, std::pmr::map, ...) can take their nodes from pools.
+class PoolResource : public std::pmr::memory_resource {
+    static constexpr size_t MIN_POOLED = 8;
+    static constexpr size_t MAX_POOLED = 1024;
+    static constexpr size_t CLASSES = std::countr_zero(MAX_POOLED) - std::countr_zero(MIN_POOLED) + 1;
+
+    std::array<std::unique_ptr<BlockPool>, CLASSES> pools;
+    std::pmr::memory_resource* upstream;
+
+    // a class of size s has blocks aligned to min(s, alignof(std::max_align_t)), so the class
+    // is chosen by the larger of size and alignment
+    static size_t SizeClass(size_t bytes, size_t alignment) {
+        bytes = std::max(bytes, alignment);
+        return std::countr_zero(std::bit_ceil(std::max(bytes, MIN_POOLED))) - std::countr_zero(MIN_POOLED);
+    }
+
+    static bool Pooled(size_t bytes, size_t alignment) {
+        return bytes <= MAX_POOLED && alignment <= alignof(std::max_align_t);
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (!Pooled(bytes, alignment)) {
+            return upstream->allocate(bytes, alignment);
+        }
+        return pools[SizeClass(bytes, alignment)]->Allocate();
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        if (!Pooled(bytes, alignment)) {
+            upstream->deallocate(p, bytes, alignment);
+        } else {
+            pools[SizeClass(bytes, alignment)]->Deallocate(p);
+        }
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    explicit PoolResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream {upstream} {
+        for (size_t c = 0; c < CLASSES; c++) {
+            size_t size = MIN_POOLED << c;
+            pools[c] = std::make_unique<BlockPool>(size, std::min(size, alignof(std::max_align_t)));
+        }
+    }
+};
+
+struct Object {
+    Object* prev = nullptr;
+    Object* next = nullptr;
+    size_t key = 0;
+    std::array<std::byte, 40> payload;
+};
+
+template <typename Alloc, typename Free>
+double churn(size_t threads, size_t objects, size_t rounds, Alloc&& allocate, Free&& free) {
+    auto start = crn::steady_clock::now();
+    {
+        std::vector<std::jthread> workers;
+        for (size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                std::mt19937 gen (static_cast<unsigned>(t));
+                std::vector<Object*> live (objects / threads);
+                for (size_t r = 0; r < rounds; r++) {
+                    for (auto& x : live) {
+                        x = allocate();
+                        x->key = r;
+                    }
+                    std::shuffle(live.begin(), live.end(), gen);
+                    for (auto x : live) {
+                        assert(x->key == r);
+                        free(x);
+                    }
+                }
+            });
+        }
+    }
+    auto end = crn::steady_clock::now();
+    return crn::duration<double, std::nano>(end - start).count() / static_cast<double>(objects * rounds);
+}
+
 int main() {
+    {
+        ObjectPool<Object> pool (256);
+        std::vector<Object*> objects;
+        for (size_t i = 0; i < 100'000; i++) {
+            objects.push_back(pool.AllocateObject());
+            objects.back()->key = i;
+        }
+        assert(pool.SlabCount() == (100'000 + 255) / 256);
+        std::sort(objects.begin(), objects.end());
+        assert(std::adjacent_find(objects.begin(), objects.end()) == objects.end());
+
+        // keep every tenth object in a doubly linked list and free the rest
+        std::mt19937 gen (1);
+        std::shuffle(objects.begin(), objects.end(), gen);
+        Object* head = nullptr;
+        size_t kept = 0;
+        for (size_t i = 0; i < objects.size(); i++) {
+            if (i % 10 == 0) {
+                objects[i]->key = kept++;
+                objects[i]->next = head;
+                if (head) {
+                    head->prev = objects[i];
+                }
+                head = objects[i];
+            } else {
+                pool.FreeObject(objects[i]);
+            }
+        }
+        size_t before = pool.SlabCount();
+        size_t released = pool.Compact([&](Object* from, Object* to) {
+            new (to) Object(std::move(*from));
+            from->~Object();
+            if (to->prev) {
+                to->prev->next = to;
+            } else {
+                head = to;
+            }
+            if (to->next) {
+                to->next->prev = to;
+            }
+        });
+        assert(released > 0 && pool.SlabCount() == before - released && pool.SlabCount() == (kept + 255) / 256);
+        size_t expected = kept;
+        for (Object* x = head; x; x = x->next) {
+            assert(x->key == --expected);
+            assert(!x->next || x->next->prev == x);
+        }
+        assert(expected == 0);
+        while (head) {
+            pool.FreeObject(std::exchange(head, head->next));
+        }
+        std::cout << "compaction released " << released << " of " << before << " slabs\n";
+    }
+
+    {
+        PoolResource resource;
+        for (size_t alignment : {1, 2, 4, 8, 16}) {
+            for (size_t bytes = 1; bytes <= 64; bytes++) {
+                std::vector<void*> blocks;
+                for (int i = 0; i < 64; i++) {
+                    blocks.push_back(resource.allocate(bytes, alignment));
+                    assert(reinterpret_cast<uintptr_t>(blocks.back()) % alignment == 0);
+                }
+                for (auto p : blocks) {
+                    resource.deallocate(p, bytes, alignment);
+                }
+            }
+        }
+        std::pmr::list<int> l (&resource);
+        std::pmr::map<int, std::pmr::string> m (&resource);
+        for (int i = 0; i < 10'000; i++) {
+            l.push_back(i);
+            m.emplace(i, std::pmr::string(static_cast<size_t>(i % 100), 'x'));
+        }
+        assert(std::accumulate(l.begin(), l.end(), 0LL) == 10'000LL * 9'999 / 2);
+        assert(m.size() == 10'000 && m.at(42).size() == 42);
+    }
+
+    constexpr size_t OBJECTS = 100'000;
+    constexpr size_t ROUNDS = 50;
+    ObjectPool<Object> pool;
+    for (size_t threads : {1, 4, 16}) {
+        double heap = churn(threads, OBJECTS, ROUNDS, [] { return new Object; }, [](Object* x) { delete x; });
+        double pooled = churn(threads, OBJECTS, ROUNDS, [&] { return pool.AllocateObject(); },
+                              [&](Object* x) { pool.FreeObject(x); });
+        std::cout << threads << " threads, alloc + free: new/delete " << heap << "ns, ObjectPool " << pooled << "ns\n";
+    }
 
+    PoolResource resource;
+    for (auto r : {std::pmr::new_delete_resource(), static_cast<std::pmr::memory_resource*>(&resource),
+                   std::pmr::new_delete_resource(), static_cast<std::pmr::memory_resource*>(&resource)}) {
+        auto start = crn::steady_clock::now();
+        for (int i = 0; i < 20; i++) {
+            std::pmr::list<int> l (r);
+            for (int k = 0; k < 200'000; k++) {
+                l.push_back(k);
+            }
+        }
+        auto end = crn::steady_clock::now();
+        std::cout << "std::pmr::list with " << (r == &resource ? "PoolResource" : "new_delete_resource") << ": "
+                  << crn::duration_cast<crn::milliseconds>(end - start).count() << "ms\n";
+    }
 }
\ No newline at end of file
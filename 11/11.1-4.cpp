@@ -1,14 +1,19 @@
 #include <cassert>
 #include <random>
 #include <array>
+#include <vector>
 
+// T is indexed by key, so it has one entry per possible key; with ten million of them it has to
+// live on the heap rather than inside the struct, which may well be on the stack
 struct Dictionary {
-    std::array<size_t, 10'000'000> T;
-    std::array<size_t, 1'000> S;
+    std::vector<size_t> T;
+    std::vector<size_t> S;
     size_t topS = 0;
 
+    Dictionary(size_t universe = 10'000'000, size_t capacity = 1'000) : T(universe), S(capacity) {}
+
     size_t Search(size_t k) {
-        if (1 <= T[k] && T[k] <= topS && S[T[k]] == k) {
+        if (T[k] < topS && S[T[k]] == k) {
             return S[T[k]];
         } else {
             return -1;
@@ -21,9 +26,11 @@ struct Dictionary {
         topS++;
     }
 
+    // moves the last key of S into the hole left by k
     void Delete(size_t k) {
-        S[T[k]] = S[topS];
-        T[S[T[k]]] = T[k];
+        size_t last = S[topS - 1];
+        S[T[k]] = last;
+        T[last] = T[k];
         T[k] = -1;
         topS--;
     }
@@ -31,5 +38,11 @@ struct Dictionary {
 };
 
 int main() {
-
+    Dictionary d;
+    d.Insert(5);
+    d.Insert(9'999'999);
+    d.Insert(42);
+    assert(d.Search(5) == 5 && d.Search(42) == 42 && d.Search(7) == size_t(-1));
+    d.Delete(5);
+    assert(d.Search(5) == size_t(-1) && d.Search(9'999'999) == 9'999'999 && d.Search(42) == 42);
 }
\ No newline at end of file
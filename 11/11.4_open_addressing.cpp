@@ -0,0 +1,616 @@
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define HAS_SSE2_GROUPS 1
+#include <emmintrin.h>
+#endif
+
+namespace crn = std::chrono;
+
+// std::hash is the identity on integers, which leaves the low bits of keys such as src * n + dst
+// badly spread; the finaliser of MurmurHash3 mixes every input bit into every output bit. The
+// hasher is transparent, so a map keyed by std::string can be searched with a std::string_view
+// or a string literal without building a std::string.
+struct FlatHash {
+    using is_transparent = void;
+
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+
+    template <std::integral K>
+    size_t operator()(K k) const {
+        return mix(static_cast<uint64_t>(k));
+    }
+
+    size_t operator()(std::string_view s) const {
+        return mix(std::hash<std::string_view>{}(s));
+    }
+};
+
+// 16 control bytes, compared at once with SSE2 where it is available
+struct Group {
+    static constexpr size_t WIDTH = 16;
+    static constexpr int8_t EMPTY = -128;
+
+#ifdef HAS_SSE2_GROUPS
+    __m128i ctrl;
+
+    explicit Group(const int8_t* p) : ctrl {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))} {}
+
+    uint32_t Match(int8_t h2) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl)));
+    }
+
+    // EMPTY is the only control byte with its sign bit set
+    uint32_t MatchEmpty() const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(ctrl));
+    }
+#else
+    int8_t ctrl[WIDTH];
+
+    explicit Group(const int8_t* p) {
+        std::memcpy(ctrl, p, WIDTH);
+    }
+
+    uint32_t Match(int8_t h2) const {
+        uint32_t bits = 0;
+        for (size_t i = 0; i < WIDTH; i++) {
+            bits |= uint32_t {ctrl[i] == h2} << i;
+        }
+        return bits;
+    }
+
+    uint32_t MatchEmpty() const {
+        return Match(EMPTY);
+    }
+#endif
+};
+
+// Open-addressing hash map in the style of Swiss tables. Next to the slots there is one control
+// byte per slot, either EMPTY or the low 7 bits of the hash (h2) of the key stored there, and
+// a lookup compares h2 against 16 control bytes at a time, so it only looks at the keys of slots
+// whose h2 matches. The remaining hash bits (h1) choose the home slot, and keys are placed by
+// linear probing: a key sits in the first empty slot at or after its home slot, so a lookup may
+// stop at the first group with an empty slot. Linear probing also lets Erase close the hole by
+// moving later keys of the same run back (backward-shift deletion), so there are no tombstones
+// and lookups never get slower as keys come and go. The price is that Erase, like Insert, may
+// move elements and invalidates iterators and references.
+template <typename Key, typename Value, typename Hash = FlatHash, typename KeyEqual = std::equal_to<>>
+class FlatHashMap {
+public:
+    using value_type = std::pair<const Key, Value>;
+
+private:
+    static constexpr size_t WIDTH = Group::WIDTH;
+    static constexpr int8_t EMPTY = Group::EMPTY;
+    static constexpr size_t MIN_CAPACITY = 16;
+
+    // the first WIDTH - 1 control bytes are repeated past the end, so that a group load that
+    // starts near the end of the table sees the slots it wraps around to
+    std::unique_ptr<int8_t[]> ctrl;
+    value_type* slots = nullptr;
+    size_t capacity = 0;
+    size_t count = 0;
+    [[no_unique_address]] Hash hash;
+    [[no_unique_address]] KeyEqual eq;
+
+    template <typename K>
+    static constexpr bool heterogeneous = std::same_as<K, Key> || (requires {
+        typename Hash::is_transparent;
+        typename KeyEqual::is_transparent;
+    } && std::is_invocable_v<const Hash&, const K&>);
+
+    // up to 7/8 of the slots are used
+    static size_t MaxLoad(size_t cap) {
+        return cap - cap / 8;
+    }
+
+    static int8_t H2(size_t h) {
+        return static_cast<int8_t>(h & 0x7F);
+    }
+
+    size_t Home(size_t h) const {
+        return (h >> 7) & (capacity - 1);
+    }
+
+    void SetCtrl(size_t i, int8_t c) {
+        ctrl[i] = c;
+        if (i < WIDTH - 1) {
+            ctrl[capacity + i] = c;
+        }
+    }
+
+    // the slot holding k, or the empty slot where k belongs if it is absent
+    template <typename K>
+    std::pair<size_t, bool> Probe(const K& k, size_t h) const {
+        const size_t mask = capacity - 1;
+        for (size_t pos = Home(h);; pos = (pos + WIDTH) & mask) {
+            Group g (&ctrl[pos]);
+            for (uint32_t bits = g.Match(H2(h)); bits; bits &= bits - 1) {
+                size_t i = (pos + static_cast<size_t>(std::countr_zero(bits))) & mask;
+                if (eq(slots[i].first, k)) {
+                    return {i, true};
+                }
+            }
+            if (uint32_t empty = g.MatchEmpty()) {
+                return {(pos + static_cast<size_t>(std::countr_zero(empty))) & mask, false};
+            }
+        }
+    }
+
+    // moves every element into fresh arrays of newCapacity slots; the keys are known to be
+    // distinct, so each only needs the first empty slot from its home on
+    void Resize(size_t newCapacity) {
+        auto oldCtrl = std::move(ctrl);
+        auto oldSlots = slots;
+        size_t oldCapacity = capacity;
+        ctrl = std::make_unique<int8_t[]>(newCapacity + WIDTH - 1);
+        std::fill_n(ctrl.get(), newCapacity + WIDTH - 1, EMPTY);
+        slots = std::allocator<value_type>().allocate(newCapacity);
+        capacity = newCapacity;
+        for (size_t i = 0; i < oldCapacity; i++) {
+            if (oldCtrl[i] != EMPTY) {
+                size_t h = hash(oldSlots[i].first);
+                size_t j = Probe(oldSlots[i].first, h).first;
+                // the key is const, so moving the element copies the key and moves the value
+                new (&slots[j]) value_type(std::move(oldSlots[i]));
+                oldSlots[i].~value_type();
+                SetCtrl(j, H2(h));
+            }
+        }
+        if (oldSlots) {
+            std::allocator<value_type>().deallocate(oldSlots, oldCapacity);
+        }
+    }
+
+    void Destroy() {
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] != EMPTY) {
+                slots[i].~value_type();
+            }
+        }
+        if (slots) {
+            std::allocator<value_type>().deallocate(slots, capacity);
+        }
+        ctrl.reset();
+        slots = nullptr;
+        capacity = 0;
+        count = 0;
+    }
+
+public:
+    template <bool Const>
+    class Iterator {
+        friend class FlatHashMap;
+        using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+        Map* map = nullptr;
+        size_t i = 0;
+
+        Iterator(Map* map, size_t i) : map {map}, i {i} {
+            skipEmpty();
+        }
+
+        void skipEmpty() {
+            while (i < map->capacity && map->ctrl[i] == EMPTY) {
+                i++;
+            }
+        }
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        operator Iterator<true>() const requires (!Const) {
+            return {map, i};
+        }
+
+        reference operator*() const {
+            return map->slots[i];
+        }
+
+        pointer operator->() const {
+            return &map->slots[i];
+        }
+
+        Iterator& operator++() {
+            i++;
+            skipEmpty();
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return i == other.i;
+        }
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    FlatHashMap() = default;
+
+    explicit FlatHashMap(size_t n) {
+        reserve(n);
+    }
+
+    FlatHashMap(const FlatHashMap& other) : hash {other.hash}, eq {other.eq} {
+        reserve(other.size());
+        for (const auto& [k, v] : other) {
+            emplace(k, v);
+        }
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+        : ctrl {std::move(other.ctrl)}, slots {std::exchange(other.slots, nullptr)},
+          capacity {std::exchange(other.capacity, 0)}, count {std::exchange(other.count, 0)},
+          hash {other.hash}, eq {other.eq} {}
+
+    FlatHashMap& operator=(FlatHashMap other) noexcept {
+        std::swap(ctrl, other.ctrl);
+        std::swap(slots, other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(count, other.count);
+        std::swap(hash, other.hash);
+        std::swap(eq, other.eq);
+        return *this;
+    }
+
+    ~FlatHashMap() {
+        Destroy();
+    }
+
+    iterator begin() {
+        return {this, 0};
+    }
+
+    iterator end() {
+        return {this, capacity};
+    }
+
+    const_iterator begin() const {
+        return {this, 0};
+    }
+
+    const_iterator end() const {
+        return {this, capacity};
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t bucket_count() const {
+        return capacity;
+    }
+
+    double load_factor() const {
+        return capacity ? static_cast<double>(count) / static_cast<double>(capacity) : 0.0;
+    }
+
+    void clear() {
+        Destroy();
+    }
+
+    // makes room for n elements at once, so inserting them never resizes
+    void reserve(size_t n) {
+        size_t cap = std::max(MIN_CAPACITY, capacity);
+        while (MaxLoad(cap) < n) {
+            cap *= 2;
+        }
+        if (cap != capacity) {
+            Resize(cap);
+        }
+    }
+
+    // rebuilds the table with the smallest capacity that holds max(n, size()) elements
+    void rehash(size_t n) {
+        size_t cap = MIN_CAPACITY;
+        while (MaxLoad(cap) < std::max(n, count)) {
+            cap *= 2;
+        }
+        Resize(cap);
+    }
+
+    template <typename K> requires heterogeneous<K>
+    iterator find(const K& k) {
+        if (count == 0) {
+            return end();
+        }
+        auto [i, found] = Probe(k, hash(k));
+        return found ? iterator(this, i) : end();
+    }
+
+    template <typename K> requires heterogeneous<K>
+    const_iterator find(const K& k) const {
+        return const_cast<FlatHashMap*>(this)->find(k);
+    }
+
+    iterator find(const Key& k) {
+        return find<Key>(k);
+    }
+
+    const_iterator find(const Key& k) const {
+        return find<Key>(k);
+    }
+
+    template <typename K>
+    bool contains(const K& k) const {
+        return find(k) != end();
+    }
+
+    template <typename K>
+    Value& at(const K& k) {
+        auto it = find(k);
+        if (it == end()) {
+            throw std::out_of_range("FlatHashMap::at");
+        }
+        return it->second;
+    }
+
+    // inserts (k, Value(args...)) unless k is present; the arguments are not used in that case
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& k, Args&&... args) {
+        if (count + 1 > MaxLoad(capacity)) {
+            reserve(count + 1);
+        }
+        size_t h = hash(k);
+        auto [i, found] = Probe(k, h);
+        if (!found) {
+            new (&slots[i]) value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(k)),
+                                       std::forward_as_tuple(std::forward<Args>(args)...));
+            SetCtrl(i, H2(h));
+            count++;
+        }
+        return {iterator(this, i), !found};
+    }
+
+    template <typename V>
+    std::pair<iterator, bool> emplace(const Key& k, V&& v) {
+        return try_emplace(k, std::forward<V>(v));
+    }
+
+    std::pair<iterator, bool> insert(const value_type& kv) {
+        return try_emplace(kv.first, kv.second);
+    }
+
+    // bulk insertion: reserves room for the whole range first
+    template <std::input_iterator It>
+    void insert(It first, It last) {
+        if constexpr (std::forward_iterator<It>) {
+            reserve(count + static_cast<size_t>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            insert(*first);
+        }
+    }
+
+    Value& operator[](const Key& k) {
+        return try_emplace(k).first->second;
+    }
+
+    // removes the element at i and moves later elements of its run back into the hole, which is
+    // allowed for an element whenever the hole is not before its home slot
+    void erase(const_iterator it) {
+        const size_t mask = capacity - 1;
+        size_t hole = it.i;
+        slots[hole].~value_type();
+        for (size_t j = (hole + 1) & mask; ctrl[j] != EMPTY; j = (j + 1) & mask) {
+            size_t home = Home(hash(slots[j].first));
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                new (&slots[hole]) value_type(std::move(slots[j]));
+                slots[j].~value_type();
+                SetCtrl(hole, ctrl[j]);
+                hole = j;
+            }
+        }
+        SetCtrl(hole, EMPTY);
+        count--;
+    }
+
+    template <typename K> requires heterogeneous<K>
+    size_t erase(const K& k) {
+        auto it = find(k);
+        if (it == end()) {
+            return 0;
+        }
+        erase(it);
+        return 1;
+    }
+
+    size_t erase(const Key& k) {
+        return erase<Key>(k);
+    }
+
+    // checks that every element can be found from its home slot and that the copies of the
+    // control bytes agree
+    void Validate() const {
+        size_t full = 0;
+        for (size_t i = 0; i < capacity; i++) {
+            if (ctrl[i] != EMPTY) {
+                full++;
+                size_t h = hash(slots[i].first);
+                assert(ctrl[i] == H2(h));
+                for (size_t j = Home(h); j != i; j = (j + 1) & (capacity - 1)) {
+                    assert(ctrl[j] != EMPTY);
+                }
+            }
+        }
+        for (size_t i = 0; i + 1 < WIDTH && capacity; i++) {
+            assert(ctrl[capacity + i] == ctrl[i]);
+        }
+        assert(full == count && count <= MaxLoad(capacity));
+    }
+};
+
+template <typename F>
+double nanosPer(size_t operations, F&& f) {
+    auto start = crn::steady_clock::now();
+    f();
+    auto end = crn::steady_clock::now();
+    return crn::duration<double, std::nano>(end - start).count() / static_cast<double>(operations);
+}
+
+// the edge index of the graph and flow classes: (src, dst) -> edge number, keyed by src * n + dst
+template <typename Map>
+void benchmark(const char* name, const std::vector<size_t>& keys, const std::vector<size_t>& misses) {
+    Map m;
+    double insert = nanosPer(keys.size(), [&] {
+        for (size_t i = 0; i < keys.size(); i++) {
+            m.emplace(keys[i], i);
+        }
+    });
+    Map reserved;
+    double insertReserved = nanosPer(keys.size(), [&] {
+        reserved.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            reserved.emplace(keys[i], i);
+        }
+    });
+    size_t sum = 0;
+    double hit = nanosPer(keys.size(), [&] {
+        for (auto k : keys) {
+            sum += m.find(k)->second;
+        }
+    });
+    size_t found = 0;
+    double miss = nanosPer(misses.size(), [&] {
+        for (auto k : misses) {
+            found += m.find(k) != m.end();
+        }
+    });
+    double iterate = nanosPer(m.size(), [&] {
+        for (const auto& [k, v] : m) {
+            sum += v;
+        }
+    });
+    double erase = nanosPer(keys.size() / 2, [&] {
+        for (size_t i = 0; i < keys.size(); i += 2) {
+            m.erase(keys[i]);
+        }
+    });
+    double hitAfterErase = nanosPer(keys.size() / 2, [&] {
+        for (size_t i = 1; i < keys.size(); i += 2) {
+            sum += m.find(keys[i])->second;
+        }
+    });
+    assert(found == 0 && m.size() == keys.size() - (keys.size() + 1) / 2);
+    std::cout << name << " (ns/op): insert " << insert << ", insert after reserve " << insertReserved
+              << ", hit " << hit << ", miss " << miss << ", iterate " << iterate << ", erase " << erase
+              << ", hit after erase " << hitAfterErase << "   [" << sum % 10 << "]\n";
+}
+
+int main() {
+    std::mt19937_64 gen (1);
+
+    // random operations against std::unordered_map, with a small key range so that erasures
+    // keep shifting long runs back
+    {
+        FlatHashMap<size_t, size_t> m;
+        std::unordered_map<size_t, size_t> ref;
+        for (int step = 0; step < 300'000; step++) {
+            size_t k = gen() % 5'000;
+            switch (gen() % 4) {
+            case 0:
+            case 1: {
+                auto [it, inserted] = m.try_emplace(k, step);
+                assert(inserted == ref.try_emplace(k, step).second && it->first == k && it->second == ref[k]);
+                break;
+            }
+            case 2:
+                assert(m.erase(k) == ref.erase(k));
+                break;
+            default:
+                assert(m.contains(k) == ref.contains(k));
+                if (m.contains(k)) {
+                    assert(m.at(k) == ref.at(k));
+                    m[k]++;
+                    ref[k]++;
+                }
+            }
+            if (step % 10'000 == 0) {
+                m.Validate();
+                assert(m.size() == ref.size());
+                for (const auto& [key, value] : m) {
+                    assert(ref.at(key) == value);
+                }
+            }
+        }
+        m.rehash(0);
+        m.Validate();
+        assert(m.size() == ref.size() && m.load_factor() > 0.4);
+        FlatHashMap<size_t, size_t> copy = m;
+        m.clear();
+        assert(m.empty() && !m.contains(size_t {1}) && copy.size() == ref.size());
+    }
+
+    // heterogeneous lookup: no std::string is built for the string_view or the literal
+    {
+        FlatHashMap<std::string, int> m;
+        std::vector<std::pair<const std::string, int>> words {{"alpha", 1}, {"beta", 2}, {"gamma", 3}};
+        m.insert(words.begin(), words.end());
+        std::string_view beta = "beta";
+        assert(m.find(beta)->second == 2 && m.contains("gamma") && !m.contains("delta"));
+        assert(m.erase("alpha") == 1 && !m.contains(std::string("alpha")) && m.size() == 2);
+    }
+
+    // a sparse graph of 1M vertices and 4M edges
+    constexpr size_t V = 1'000'000;
+    constexpr size_t E = 4'000'000;
+    std::vector<size_t> keys;
+    std::vector<size_t> misses;
+    {
+        std::unordered_map<size_t, bool> seen;
+        while (keys.size() < E) {
+            size_t key = gen() % V * V + gen() % V;
+            if (seen.try_emplace(key, true).second) {
+                keys.push_back(key);
+            }
+        }
+        while (misses.size() < E) {
+            size_t key = gen() % V * V + gen() % V;
+            if (!seen.contains(key)) {
+                misses.push_back(key);
+            }
+        }
+    }
+    benchmark<std::unordered_map<size_t, size_t>>("std::unordered_map", keys, misses);
+    benchmark<FlatHashMap<size_t, size_t>>("FlatHashMap", keys, misses);
+}
\ No newline at end of file
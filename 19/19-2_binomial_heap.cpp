@@ -1,14 +1,21 @@
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
 #include <iterator>
 #include <limits>
 #include <memory>
 #include <optional>
+#include <queue>
+#include <random>
 #include <utility>
 #include <vector>
 #include <ranges>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
 
 template <typename T>
 class BinomialHeap {
@@ -137,16 +144,266 @@ public:
 };
 
 
-int main() {
+// hands out nodes from fixed-size slabs so their addresses never change; freed nodes are reused
+template <typename Node, std::size_t SlabSize = 1024>
+class SlabArena {
+    std::vector<std::unique_ptr<Node[]>> slabs;
+    std::size_t used = SlabSize;
+    std::vector<Node*> freeList;
+
+public:
+    Node* allocate() {
+        if (!freeList.empty()) {
+            auto x = freeList.back();
+            freeList.pop_back();
+            return x;
+        }
+        if (used == SlabSize) {
+            slabs.push_back(std::make_unique<Node[]>(SlabSize));
+            used = 0;
+        }
+        return &slabs.back()[used++];
+    }
+
+    void deallocate(Node* x) {
+        freeList.push_back(x);
+    }
+};
+
+// binomial heap that only links trees in DeleteMinimum: Insert and Merge just append to the
+// root list, so both are O(1) worst case. Heaps that are merged must share one node pool.
+template <typename T>
+class LazyBinomialHeap {
+    static_assert(std::is_arithmetic_v<T>);
+    struct Node {
+        T key {};
+        Node* child = nullptr;
+        Node* sibling = nullptr;
+        std::uint32_t degree = 0;
+    };
+
+public:
+    using Pool = SlabArena<Node>;
+
+private:
+    Pool* pool;
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    Node* min = nullptr;
+    std::array<Node*, std::numeric_limits<std::size_t>::digits + 1> degreeTable {};
+
+    void pushRoot(Node* x) {
+        x->sibling = nullptr;
+        if (tail) {
+            tail->sibling = x;
+        } else {
+            head = x;
+        }
+        tail = x;
+        if (!min || x->key < min->key) {
+            min = x;
+        }
+    }
+
+    static Node* link(Node* x, Node* y) {
+        if (y->key < x->key) {
+            std::swap(x, y);
+        }
+        y->sibling = x->child;
+        x->child = y;
+        x->degree++;
+        return x;
+    }
+
+    void release(Node* x) {
+        while (x) {
+            release(x->child);
+            auto next = x->sibling;
+            pool->deallocate(x);
+            x = next;
+        }
+    }
+
+public:
+    explicit LazyBinomialHeap(Pool& pool) : pool {&pool} {}
+
+    LazyBinomialHeap(const LazyBinomialHeap&) = delete;
+    LazyBinomialHeap& operator=(const LazyBinomialHeap&) = delete;
+
+    ~LazyBinomialHeap() {
+        release(head);
+    }
+
+    [[nodiscard]] bool isEmpty() const {
+        return !head;
+    }
+
+    void Insert(const T& key) {
+        auto x = pool->allocate();
+        *x = Node {};
+        x->key = key;
+        pushRoot(x);
+    }
+
+    void Merge(LazyBinomialHeap& other_heap) noexcept {
+        assert(pool == other_heap.pool);
+        if (!other_heap.head) {
+            return;
+        }
+        if (tail) {
+            tail->sibling = other_heap.head;
+        } else {
+            head = other_heap.head;
+        }
+        tail = other_heap.tail;
+        if (!min || other_heap.min->key < min->key) {
+            min = other_heap.min;
+        }
+        other_heap.head = nullptr;
+        other_heap.tail = nullptr;
+        other_heap.min = nullptr;
+    }
+
+    [[nodiscard]] std::optional<T> FindMinimum() const {
+        if (!min) {
+            return {};
+        }
+        return min->key;
+    }
+
+    void DeleteMinimum() noexcept {
+        if (!min) {
+            return;
+        }
+        std::size_t maxDegree = 0;
+        auto insert = [&](Node* x) {
+            auto d = x->degree;
+            while (degreeTable[d]) {
+                x = link(x, degreeTable[d]);
+                degreeTable[d] = nullptr;
+                d++;
+            }
+            degreeTable[d] = x;
+            maxDegree = std::max<std::size_t>(maxDegree, d);
+        };
+        for (auto x = head; x; ) {
+            auto next = x->sibling;
+            if (x != min) {
+                insert(x);
+            }
+            x = next;
+        }
+        for (auto x = min->child; x; ) {
+            auto next = x->sibling;
+            insert(x);
+            x = next;
+        }
+        pool->deallocate(min);
 
+        head = nullptr;
+        tail = nullptr;
+        min = nullptr;
+        for (std::size_t d = 0; d <= maxDegree; d++) {
+            if (degreeTable[d]) {
+                pushRoot(degreeTable[d]);
+                degreeTable[d] = nullptr;
+            }
+        }
+    }
+};
+
+int main() {
     BinomialHeap<int> bheap;
+    LazyBinomialHeap<int>::Pool pool;
+    LazyBinomialHeap<int> lheap (pool);
 
     for (int i = 1; i <= 100; i++) {
         bheap.Insert(i);
+        lheap.Insert(101 - i);
     }
     for (int i = 1; i <= 100; i++) {
+        assert(bheap.FindMinimum() == i);
+        assert(lheap.FindMinimum() == i);
         bheap.DeleteMinimum();
+        lheap.DeleteMinimum();
+    }
+    assert(lheap.isEmpty() && !lheap.FindMinimum());
+
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<> dist;
+    {
+        std::priority_queue<int, std::vector<int>, std::greater<>> ref;
+        LazyBinomialHeap<int> heap (pool);
+        for (std::size_t step = 0; step < 100'000; step++) {
+            if (gen() % 3 || ref.empty()) {
+                LazyBinomialHeap<int> shard (pool);
+                for (std::size_t i = gen() % 8; i > 0; i--) {
+                    auto x = dist(gen);
+                    shard.Insert(x);
+                    ref.push(x);
+                }
+                heap.Merge(shard);
+            } else {
+                assert(heap.FindMinimum() == ref.top());
+                heap.DeleteMinimum();
+                ref.pop();
+            }
+        }
     }
 
+    // every round fills many small per-shard queues, melds them into one and drains a few minima
+    constexpr std::size_t SHARDS = 4'096;
+    constexpr std::size_t PER_SHARD = 16;
+    constexpr std::size_t ROUNDS = 50;
+    constexpr std::size_t DELETES = 256;
+    std::vector<int> keys (SHARDS * PER_SHARD);
+    for (auto& x : keys) {
+        x = dist(gen);
+    }
 
+    crn::microseconds DT1(0), DT2(0);
+    long long check1 = 0, check2 = 0;
+    {
+        BinomialHeap<int> global;
+        auto t1 = crn::steady_clock::now();
+        for (std::size_t r = 0; r < ROUNDS; r++) {
+            for (std::size_t s = 0; s < SHARDS; s++) {
+                BinomialHeap<int> shard;
+                for (std::size_t i = 0; i < PER_SHARD; i++) {
+                    shard.Insert(keys[s * PER_SHARD + i]);
+                }
+                global.Merge(shard);
+            }
+            for (std::size_t i = 0; i < DELETES; i++) {
+                check1 += *global.FindMinimum();
+                global.DeleteMinimum();
+            }
+        }
+        auto t2 = crn::steady_clock::now();
+        DT1 = crn::duration_cast<crn::microseconds>(t2 - t1);
+    }
+    {
+        LazyBinomialHeap<int> global (pool);
+        auto t1 = crn::steady_clock::now();
+        for (std::size_t r = 0; r < ROUNDS; r++) {
+            for (std::size_t s = 0; s < SHARDS; s++) {
+                LazyBinomialHeap<int> shard (pool);
+                for (std::size_t i = 0; i < PER_SHARD; i++) {
+                    shard.Insert(keys[s * PER_SHARD + i]);
+                }
+                global.Merge(shard);
+            }
+            for (std::size_t i = 0; i < DELETES; i++) {
+                check2 += *global.FindMinimum();
+                global.DeleteMinimum();
+            }
+        }
+        auto t2 = crn::steady_clock::now();
+        DT2 = crn::duration_cast<crn::microseconds>(t2 - t1);
+    }
+    assert(check1 == check2);
+    std::cout << ROUNDS << " rounds of " << SHARDS << " shard melds (" << PER_SHARD << " keys each) and "
+              << DELETES << " delete-mins\n";
+    std::cout << "  Eager binomial heap : " << DT1.count() << "us\n";
+    std::cout << "  Lazy binomial heap (pooled nodes) : " << DT2.count() << "us\n";
 }
\ No newline at end of file
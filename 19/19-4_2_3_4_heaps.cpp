@@ -1,51 +1,73 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <iostream>
 #include <iterator>
+#include <limits>
 #include <memory>
+#include <mutex>
 #include <numeric>
 #include <optional>
 #include <random>
 #include <ranges>
+#include <span>
+#include <thread>
 #include <utility>
 #include <vector>
 
 namespace sr = std::ranges;
 namespace srv = std::ranges::views;
+namespace crn = std::chrono;
 
 template <typename T>
 concept Key = std::is_arithmetic_v<T>;
 
+// Keys live in the leaves, every internal node has 2 to 4 children and caches the smallest key
+// below it. Nodes directly above the leaves have height 2.
+// ConcurrentInsert and ConcurrentDecreaseKey may be called from several threads at once (but not
+// together with the other operations). Inserts descend with hand-over-hand locking and split full
+// nodes on the way down, so they only ever wait for a lock below one they hold; DecreaseKey holds
+// one lock at a time while it walks up, so the two can never deadlock.
 template <Key T>
 class BHeap {
     class Node {
-        Node* parent = nullptr;
+        std::atomic<Node*> parent = nullptr;
         std::size_t index = 0;
         std::size_t height = 1;
-        T small = std::numeric_limits<T>::max();
+        std::atomic<T> small = std::numeric_limits<T>::max();
         std::optional<T> key;
         std::vector<std::unique_ptr<Node>> child;
+        std::mutex mutex;
 
         friend class BHeap;
 
         void validateChild() {
             if (child.empty()) {
-                assert(key.has_value());
-                curr->small = key;
+                // only a leaf or the root of an empty heap has no children
+                small = key.value_or(std::numeric_limits<T>::max());
             } else {
-                curr->small = child[0]->small;
+                T s = child[0]->small;
                 for (std::size_t i = 0; i < child.size(); i++) {
                     child[i]->index = i;
                     child[i]->parent = this;
-                    curr->small = std::min(child[i]->small, curr->small);
+                    s = std::min<T>(child[i]->small, s);
                 }
+                small = s;
+            }
+        }
+
+        void lower(const T& k) {
+            if (k < small) {
+                small = k;
             }
         }
 
         void Merge(std::size_t i) noexcept {
-            child[i]->child.resize(3);
-            sr::move(child[i + 1]->child, child[i]->child.begin() + 1);
+            sr::move(child[i + 1]->child, std::back_inserter(child[i]->child));
             std::shift_left(child.begin() + i + 1, child.end(), 1);
             child.pop_back();
             validateChild();
@@ -53,8 +75,8 @@ class BHeap {
         }
 
         void LeftRotate() noexcept {
-            assert(index + 1 < parent->child.size());
-            auto sibling = parent->child[index + 1].get();
+            assert(index + 1 < parent.load()->child.size());
+            auto sibling = parent.load()->child[index + 1].get();
             child.push_back(std::move(sibling->child[0]));
             std::shift_left(sibling->child.begin(), sibling->child.end(), 1);
             sibling->child.pop_back();
@@ -63,8 +85,8 @@ class BHeap {
         }
 
         void RightRotate() noexcept {
-            assert(index - 1 < parent->child.size());
-            auto sibling = parent->child[index - 1].get();
+            assert(index - 1 < parent.load()->child.size());
+            auto sibling = parent.load()->child[index - 1].get();
             child.resize(child.size() + 1);
             std::shift_right(child.begin(), child.end(), 1);
             child[0] = std::move(sibling->child[sibling->child.size() - 1]);
@@ -75,6 +97,14 @@ class BHeap {
     };
 
     std::unique_ptr<Node> root;
+    std::mutex rootMutex;
+
+    static std::unique_ptr<Node> makeLeaf(const T& k) {
+        auto leaf = std::make_unique<Node>();
+        leaf->key = k;
+        leaf->small = k;
+        return leaf;
+    }
 
     [[nodiscard]] const Node* Minimum(const Node* node) const {
         if (node->child.empty()) {
@@ -114,86 +144,264 @@ class BHeap {
         y->validateChild();
     }
 
-    void InsertNonFull(Node* x, const T& k) {
-        if (x->child[0]->child.empty()) {
-            x->child.push_back(std::make_unique<Node>());
-            x->child.back()->key = k;
-            auto curr = x->child.back().get();
-            while (curr) {
-                curr->small = std::min(curr->small, k);
-                curr = curr->parent;
+    // SplitChild for the concurrent mode: the caller holds the locks of x and of y = x->child[i],
+    // and gets back the lock of the new sibling z, taken before any child of y is pointed at it
+    static std::unique_lock<std::mutex> ConcurrentSplitChild(Node* x, std::size_t i) {
+        auto y = x->child[i].get();
+        assert(x->child.size() != 4 && y->child.size() == 4);
+        auto z = std::make_unique<Node>();
+        // z is not reachable by other threads yet, so this cannot fail (nor wait on anyone)
+        std::unique_lock zl (z->mutex, std::try_to_lock);
+        assert(zl.owns_lock());
+        z->height = y->height;
+        z->child.resize(2);
+        sr::move(y->child | srv::drop(2), z->child.begin());
+        z->validateChild();
+        y->child.resize(2);
+        y->validateChild();
+        x->child.resize(x->child.size() + 1);
+        std::shift_right(x->child.begin() + i + 1, x->child.end(), 1);
+        x->child[i + 1] = std::move(z);
+        x->validateChild();
+        return zl;
+    }
+
+    Node* InsertNonFull(Node* x, const T& k) {
+        if (x->height == 2) {
+            x->child.push_back(makeLeaf(k));
+            auto leaf = x->child.back().get();
+            leaf->parent = x;
+            leaf->index = x->child.size() - 1;
+            for (auto curr = x; curr; curr = curr->parent) {
+                curr->lower(k);
             }
+            return leaf;
         } else {
             if (x->child[0]->child.size() == 4) { // is full? then split
                 SplitChild(x, 0);
             }
-            InsertNonFull(x->child[0].get(), k); // recursively insert
+            return InsertNonFull(x->child[0].get(), k); // recursively insert
         }
     }
 
+    // recomputes the cached minima on the path from x to the root
+    static void refreshPath(Node* x) {
+        for (; x; x = x->parent) {
+            x->validateChild();
+        }
+    }
+
+    // splits y, which has more than 4 children, into y and a new right sibling
+    static void SplitOverfull(Node* y) {
+        Node* p = y->parent;
+        std::size_t curN = y->child.size();
+        std::size_t rightN = curN / 2;
+        auto z = std::make_unique<Node>(); // will be y's right sibling
+        z->height = y->height;
+        sr::move(y->child | srv::drop(curN - rightN), std::back_inserter(z->child));
+        y->child.resize(curN - rightN);
+        z->validateChild();
+        y->validateChild();
+        p->child.insert(p->child.begin() + y->index + 1, std::move(z));
+        p->validateChild();
+    }
+
+    void GrowIfOverfull() {
+        if (root->child.size() > 4) {
+            auto s = std::make_unique<Node>();
+            s->height = root->height + 1;
+            s->child.push_back(std::move(root));
+            root = std::move(s);
+            root->validateChild();
+            SplitOverfull(root->child[0].get());
+        }
+    }
+
+    static std::size_t defaultThreads() {
+        return std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
 public:
-    BHeap() : root {std::make_unique<Node>()} {}
+    BHeap() : root {std::make_unique<Node>()} {
+        root->height = 2;
+    }
+
+    // builds the tree bottom-up in O(n): each level groups the nodes below it into runs of 2 to 4
+    // children, and the runs of one level are built by threads in parallel
+    explicit BHeap(std::span<const T> keys, std::size_t threads = defaultThreads()) : BHeap() {
+        if (keys.empty()) {
+            return;
+        }
+        std::vector<std::unique_ptr<Node>> level (keys.size());
+        auto forChunks = [threads](std::size_t n, auto f) {
+            std::size_t t = std::clamp<std::size_t>(n / 4'096, 1, threads);
+            std::vector<std::jthread> workers;
+            for (std::size_t j = 1; j < t; j++) {
+                workers.emplace_back(f, j * n / t, (j + 1) * n / t);
+            }
+            f(0, n / t);
+        };
+        forChunks(keys.size(), [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t i = lo; i < hi; i++) {
+                level[i] = makeLeaf(keys[i]);
+            }
+        });
+        std::size_t height = 2;
+        do {
+            std::size_t m = level.size();
+            std::size_t groups = (m + 3) / 4;
+            std::vector<std::unique_ptr<Node>> next (groups);
+            forChunks(groups, [&](std::size_t lo, std::size_t hi) {
+                for (std::size_t g = lo; g < hi; g++) {
+                    auto x = std::make_unique<Node>();
+                    x->height = height;
+                    for (std::size_t i = g * m / groups; i < (g + 1) * m / groups; i++) {
+                        x->child.push_back(std::move(level[i]));
+                    }
+                    x->validateChild();
+                    next[g] = std::move(x);
+                }
+            });
+            level = std::move(next);
+            height++;
+        } while (level.size() > 1);
+        root = std::move(level[0]);
+    }
 
     [[nodiscard]] const Node* Minimum() const {
         return Minimum(root.get());
     }
 
+    [[nodiscard]] std::optional<T> FindMinimum() const {
+        if (root->child.empty()) {
+            return {};
+        }
+        return root->small.load();
+    }
+
     void DecreaseKey(Node* x, const T& k) {
         if (!x->key.has_value() || x->key < k) {
             return;
         }
         x->key = k;
         while (x) {
-            x->small = std::min(x->small, k);
+            x->lower(k);
             x = x->parent;
         }
     }
 
-    void Insert(const T& k) noexcept {
+    Node* Insert(const T& k) noexcept {
         if (root->child.size() == 4) {
             auto s = std::make_unique<Node>();
             s->height = root->height + 1;
             s->child.push_back(std::move(root));
             root = std::move(s);
+            root->validateChild();
             SplitChild(root.get(), 0);
-            InsertNonFull(root.get(), k);
-        } else if (root->child.empty()) {
-            root->child.push_back(std::make_unique<Node>());
-            root->child[0]->key = k;
-        } else {
-            InsertNonFull(root.get(), k);
+        }
+        return InsertNonFull(root.get(), k);
+    }
+
+    Node* ConcurrentInsert(const T& k) {
+        // each thread keeps descending the same way, so its path stays in cache and
+        // different threads spread over different subtrees instead of all taking the leftmost one
+        thread_local std::size_t lane = std::hash<std::thread::id>{}(std::this_thread::get_id()) * 0x9E3779B97F4A7C15ull;
+        std::unique_lock rl (rootMutex);
+        Node* x = root.get();
+        std::unique_lock xl (x->mutex);
+        if (x->child.size() == 4) {
+            auto s = std::make_unique<Node>();
+            std::unique_lock sl (s->mutex, std::try_to_lock);
+            assert(sl.owns_lock());
+            s->height = x->height + 1;
+            s->child.push_back(std::move(root));
+            root = std::move(s);
+            root->validateChild();
+            ConcurrentSplitChild(root.get(), 0);
+            xl = std::move(sl);
+            x = root.get();
+        }
+        rl.unlock();
+        x->lower(k);
+        while (x->height > 2) {
+            std::size_t turn = lane >> (2 * (x->height % 32));
+            std::size_t i = turn % x->child.size();
+            Node* y = x->child[i].get();
+            std::unique_lock yl (y->mutex);
+            if (y->child.size() == 4) {
+                auto zl = ConcurrentSplitChild(x, i);
+                // the split recomputed x->small from children that do not hold k yet
+                x->lower(k);
+                if (turn & 4) {
+                    y = x->child[i + 1].get();
+                    yl = std::move(zl);
+                }
+            }
+            y->lower(k);
+            xl = std::move(yl);
+            x = y;
+        }
+        x->child.push_back(makeLeaf(k));
+        auto leaf = x->child.back().get();
+        leaf->index = x->child.size() - 1;
+        leaf->parent = x;
+        return leaf;
+    }
+
+    void ConcurrentDecreaseKey(Node* x, const T& k) {
+        {
+            std::lock_guard lock (x->mutex);
+            if (!x->key.has_value() || x->key < k) {
+                return;
+            }
+            x->key = k;
+            x->small = k;
+        }
+        // A split may move x under a new parent between reading x->parent and locking it. The
+        // walk cannot stop early at an ancestor whose minimum is already <= k: a concurrent split
+        // recomputes the minima of the nodes it touches from their children, so it may already
+        // have pulled k into one of them without passing it on to that node's ancestors.
+        while (Node* p = x->parent) {
+            std::lock_guard lock (p->mutex);
+            if (x->parent != p) {
+                continue;
+            }
+            p->lower(k);
+            x = p;
         }
     }
 
     void Delete(Node* x) noexcept {
         Node* curr = x->parent;
-        std::shift_left(x->parent->child.begin() + x->index, x->parent->child.end(), 1);
+        std::shift_left(curr->child.begin() + x->index, curr->child.end(), 1);
         curr->child.pop_back();
         curr->validateChild();
-        while (curr && curr->parent && curr->child.size() == 1) {
+        while (curr->parent && curr->child.size() == 1) {
+            Node* p = curr->parent;
             std::size_t i = curr->index;
-            if (i + 1 < curr->parent->child.size() && curr->parent->child[i + 1]->child.size() > 2) {
+            if (i + 1 < p->child.size() && p->child[i + 1]->child.size() > 2) {
                 curr->LeftRotate();
-            } else if (i - 1 < curr->parent->child.size() && curr->parent->child[i - 1]->child.size() > 2) {
+            } else if (i > 0 && p->child[i - 1]->child.size() > 2) {
                 curr->RightRotate();
-            } else if (i + 1 < curr->parent->child.size()) {
-                curr->parent->Merge(i);
-                if (curr->parent == root.get() && curr->parent->child.size() == 1) {
-                    root = std::move(curr->parent->child[i]);
-                    root->parent = nullptr;
-                }
-            } else if (i - 1 < curr->parent->child.size()) {
-                curr->parent->Merge(i - 1);
-                if (curr->parent == root.get() && curr->parent->child.size() == 1) {
-                    root = std::move(curr->parent->child[i - 1]);
-                    root->parent = nullptr;
-                }
+            } else if (i + 1 < p->child.size()) {
+                p->Merge(i);
+            } else {
+                p->Merge(i - 1);
             }
-            curr = curr->parent;
+            curr = p;
+        }
+        refreshPath(curr);
+        if (root->height > 2 && root->child.size() == 1) {
+            auto c = std::move(root->child[0]);
+            root = std::move(c);
+            root->parent = nullptr;
         }
     }
 
     void ExtractMin() {
+        if (root->child.empty()) {
+            return;
+        }
         auto x = const_cast<Node*>(Minimum());
         Delete(x);
     }
@@ -203,79 +411,62 @@ public:
     }
 
     void Union(BHeap& other_heap) {
-        if (getHeight() < other_heap.getHeight()) {
-            std::swap(root, other_heap.root);
+        if (other_heap.root->child.empty()) {
+            return;
         }
-        if (getHeight() == other_heap.getHeight()) {
-            sr::move(other_heap.root->child, std::back_inserter(root->child));
-            root->validateChild();
-            std::size_t curN = root->child.size();
-            if (curN > 4) {
-                auto s = std::make_unique<Node>();
-                s->height = tree1.root->height + 1;
-                s->child.push_back(std::move(root));
-                root = std::move(s);
-                std::size_t rightN = (curN + 1) / 2;
-                auto z = std::make_unique<Node>(); // will be y's right sibling
-                Node* y = root->child[0].get();
-                z->height = y->height;
-                sr::move(y->child | srv::drop(curN - rightN), std::back_inserter(z->child));
-                z->validateChild();
-                Node* p = root.get();
-                p->child.push_back(std::move(z));
-                y->child.resize(curN - rightN);
-                p->validateChild();
-                y->validateChild();
-            }
-        } else {
-            Node* r1 = root.get();
-            for (std::size_t i = 0; i < getHeight() - other_heap.getHeight(); i++) {
-                r1 = r1->child.back().get();
-            }
-            Node* r2 = other_heap.root.get();
-            sr::move(r2->child, std::back_inserter(r1->child));
-            r1->validateChild();
-            std::size_t curN = r1->child.size();
-            while (r1->parent && r1->child.size() > 4) {
-                std::size_t curN = r1->child.size();
-                auto z = std::make_unique<Node>(); // will be y's right sibling
-                z->height = r1->height;
-                std::size_t rightN = (curN + 1) / 2;
-                Node* y = root->child[0].get();
-                z->height = y->height;
-                sr::move(y->child | srv::drop(curN - rightN), std::back_inserter(z->child));
-                z->validateChild();
-                Node* p = r1->parent;
-                p->child.push_back(std::move(z));
-                y->child.resize(curN - rightN);
-                p->validateChild();
-                y->validateChild();
-                r1->validateChild();
-                r1 = p;
-            }
-            std::size_t curN = root->child.size();
-            if (curN > 4) {
-                auto s = std::make_unique<Node>();
-                s->height = tree1.root->height + 1;
-                s->child.push_back(std::move(root));
-                root = std::move(s);
-                std::size_t rightN = (curN + 1) / 2;
-                auto z = std::make_unique<Node>(); // will be y's right sibling
-                Node* y = root->child[0].get();
-                z->height = y->height;
-                sr::move(y->child | srv::drop(curN - rightN), std::back_inserter(z->child));
-                z->validateChild();
-                Node* p = root.get();
-                p->child.push_back(std::move(z));
-                y->child.resize(curN - rightN);
-                p->validateChild();
-                y->validateChild();
+        if (getHeight() < other_heap.getHeight() || root->child.empty()) {
+            std::swap(root, other_heap.root);
+            if (other_heap.root->child.empty()) {
+                return;
             }
         }
+        Node* r1 = root.get();
+        for (std::size_t i = 0; i < getHeight() - other_heap.getHeight(); i++) {
+            r1 = r1->child.back().get();
+        }
+        Node* r2 = other_heap.root.get();
+        sr::move(r2->child, std::back_inserter(r1->child));
+        r2->child.clear();
+        r1->validateChild();
+        Node* bottom = r1;
+        while (r1->parent && r1->child.size() > 4) {
+            Node* p = r1->parent;
+            SplitOverfull(r1);
+            r1 = p;
+        }
+        refreshPath(bottom);
+        GrowIfOverfull();
     }
 
 };
 
+template <Key T>
+std::vector<T> drain(BHeap<T>& heap) {
+    std::vector<T> out;
+    while (auto k = heap.FindMinimum()) {
+        out.push_back(*k);
+        heap.ExtractMin();
+    }
+    return out;
+}
+
+// each producer inserts its share of keys and lowers the key of every 4th element it inserted
+template <typename F>
+crn::milliseconds produce(std::size_t threads, const std::vector<int>& keys, std::vector<int>& final_keys, F f) {
+    auto t1 = crn::steady_clock::now();
+    {
+        std::vector<std::jthread> producers;
+        for (std::size_t t = 0; t < threads; t++) {
+            producers.emplace_back([&, t] {
+                std::size_t lo = t * keys.size() / threads;
+                std::size_t hi = (t + 1) * keys.size() / threads;
+                f(std::span(keys).subspan(lo, hi - lo), std::span(final_keys).subspan(lo, hi - lo));
+            });
+        }
+    }
+    auto t2 = crn::steady_clock::now();
+    return crn::duration_cast<crn::milliseconds>(t2 - t1);
+}
 
 int main() {
     BHeap<int> bheap;
@@ -291,9 +482,91 @@ int main() {
         bheap.Insert(n);
     }
 
-    for (auto n : v) {
+    for (int i = 1; i <= static_cast<int>(N); i++) {
+        assert(bheap.FindMinimum() == i);
         bheap.ExtractMin();
     }
+    assert(!bheap.FindMinimum());
 
+    std::uniform_int_distribution<> dist(0, 1'000'000'000);
+    for (std::size_t n : {0, 1, 2, 5, 17, 1'000, 100'000}) {
+        std::vector<int> keys (n);
+        for (auto& k : keys) {
+            k = dist(gen);
+        }
+        BHeap<int> built (keys);
+        BHeap<int> other (std::span<const int>(keys).first(n / 3));
+        built.Union(other);
+        keys.insert(keys.end(), keys.begin(), keys.begin() + n / 3);
+        sr::sort(keys);
+        assert(drain(built) == keys);
+    }
+
+    constexpr std::size_t M = 1'000'000;
+    std::vector<int> keys (M);
+    for (auto& k : keys) {
+        k = dist(gen);
+    }
+    {
+        auto t1 = crn::steady_clock::now();
+        BHeap<int> inserted;
+        for (auto k : keys) {
+            inserted.Insert(k);
+        }
+        auto t2 = crn::steady_clock::now();
+        BHeap<int> serial (keys, 1);
+        auto t3 = crn::steady_clock::now();
+        BHeap<int> parallel (keys);
+        auto t4 = crn::steady_clock::now();
+        assert(inserted.FindMinimum() == *sr::min_element(keys));
+        assert(serial.FindMinimum() == inserted.FindMinimum() && parallel.FindMinimum() == inserted.FindMinimum());
+        std::cout << M << " keys, one Insert at a time : "
+                  << crn::duration_cast<crn::milliseconds>(t2 - t1).count() << "ms\n";
+        std::cout << M << " keys, bottom-up build : "
+                  << crn::duration_cast<crn::milliseconds>(t3 - t2).count() << "ms\n";
+        std::cout << M << " keys, parallel bottom-up build : "
+                  << crn::duration_cast<crn::milliseconds>(t4 - t3).count() << "ms\n";
+    }
+
+    std::size_t maxThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    for (std::size_t threads = 1; threads <= 2 * maxThreads; threads *= 2) {
+        std::vector<int> final_keys (M);
+        BHeap<int> locked;
+        std::mutex heapMutex;
+        auto dt1 = produce(threads, keys, final_keys, [&](std::span<const int> in, std::span<int> out) {
+            std::vector<decltype(locked.Insert(0))> handles;
+            for (std::size_t i = 0; i < in.size(); i++) {
+                std::lock_guard lock (heapMutex);
+                handles.push_back(locked.Insert(in[i]));
+                out[i] = in[i];
+                if (i % 4 == 3) {
+                    out[i - 2] -= 1'000;
+                    locked.DecreaseKey(handles[i - 2], out[i - 2]);
+                }
+            }
+        });
+        auto expected = final_keys;
+        sr::sort(expected);
+        assert(drain(locked) == expected);
+
+        BHeap<int> shared;
+        auto dt2 = produce(threads, keys, final_keys, [&](std::span<const int> in, std::span<int> out) {
+            std::vector<decltype(shared.ConcurrentInsert(0))> handles;
+            for (std::size_t i = 0; i < in.size(); i++) {
+                handles.push_back(shared.ConcurrentInsert(in[i]));
+                out[i] = in[i];
+                if (i % 4 == 3) {
+                    out[i - 2] -= 1'000;
+                    shared.ConcurrentDecreaseKey(handles[i - 2], out[i - 2]);
+                }
+            }
+        });
+        assert(drain(shared) == expected);
 
+        std::cout << threads << " producer threads, " << M << " inserts and " << M / 4 << " decrease-keys\n";
+        std::cout << "  one heap-wide mutex : " << dt1.count() << "ms ("
+                  << M * 1'000 / std::max<std::int64_t>(dt1.count(), 1) << " inserts/s)\n";
+        std::cout << "  per-node locks : " << dt2.count() << "ms ("
+                  << M * 1'000 / std::max<std::int64_t>(dt2.count(), 1) << " inserts/s)\n";
+    }
 }
\ No newline at end of file
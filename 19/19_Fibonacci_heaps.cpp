@@ -1,15 +1,23 @@
 #include <cassert>
+#include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <utility>
 #include <vector>
 #include <memory>
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <list>
+#include <random>
+#include <set>
 #include <unordered_set>
 #include <unordered_map>
 #include <functional>
+#include <ranges>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
 
 template <typename T>
 concept arithmetic = std::is_arithmetic_v<T>;
@@ -247,6 +255,498 @@ public:
     }
 };
 
+// hands out nodes from fixed-size slabs so their addresses never change; freed nodes are reused
+template <typename Node, std::size_t SlabSize = 1024>
+class SlabArena {
+    std::vector<std::unique_ptr<Node[]>> slabs;
+    std::size_t used = SlabSize;
+    std::vector<Node*> freeList;
+
+public:
+    Node* allocate() {
+        if (!freeList.empty()) {
+            auto x = freeList.back();
+            freeList.pop_back();
+            return x;
+        }
+        if (used == SlabSize) {
+            slabs.push_back(std::make_unique<Node[]>(SlabSize));
+            used = 0;
+        }
+        return &slabs.back()[used++];
+    }
+
+    void deallocate(Node* x) {
+        freeList.push_back(x);
+    }
+
+    // takes ownership of other's nodes; the remainder of other's current slab is abandoned
+    void splice(SlabArena& other) {
+        slabs.insert(slabs.begin(), std::make_move_iterator(other.slabs.begin()),
+                     std::make_move_iterator(other.slabs.end()));
+        freeList.insert(freeList.end(), other.freeList.begin(), other.freeList.end());
+        other.slabs.clear();
+        other.freeList.clear();
+        other.used = SlabSize;
+    }
+};
+
+// floor(log_phi(2^64)) + 1 bounds the degree of any node
+constexpr std::size_t MAX_DEGREE = 93;
+
+template <arithmetic T, typename V>
+class ArenaFibonacciHeap {
+    struct Node {
+        Node* left = nullptr;
+        Node* right = nullptr;
+        Node* parent = nullptr;
+        Node* child = nullptr;
+        std::uint32_t degree = 0;
+        bool mark = false;
+        T key {};
+        V value {};
+    };
+
+    Node* min = nullptr;
+    std::size_t n = 0;
+    SlabArena<Node> arena;
+    std::array<Node*, MAX_DEGREE> degreeTable {};
+
+    // inserts x into the circular list next to pos
+    static void splice(Node* pos, Node* x) {
+        x->left = pos;
+        x->right = pos->right;
+        pos->right->left = x;
+        pos->right = x;
+    }
+
+    static void unlink(Node* x) {
+        x->left->right = x->right;
+        x->right->left = x->left;
+    }
+
+    void addToRoot(Node* x) {
+        x->parent = nullptr;
+        x->mark = false;
+        if (!min) {
+            x->left = x;
+            x->right = x;
+            min = x;
+        } else {
+            splice(min, x);
+            if (x->key < min->key) {
+                min = x;
+            }
+        }
+    }
+
+    void link(Node* y, Node* x) {
+        unlink(y);
+        if (!x->child) {
+            y->left = y;
+            y->right = y;
+            x->child = y;
+        } else {
+            splice(x->child, y);
+        }
+        y->parent = x;
+        y->mark = false;
+        x->degree++;
+    }
+
+    void consolidate() {
+        std::size_t roots = 0;
+        auto curr = min;
+        do {
+            roots++;
+            curr = curr->right;
+        } while (curr != min);
+
+        std::size_t maxDegree = 0;
+        auto w = min;
+        for (std::size_t i = 0; i < roots; i++) {
+            auto next = w->right;
+            auto x = w;
+            auto d = x->degree;
+            while (degreeTable[d]) {
+                auto y = degreeTable[d];
+                if (y->key < x->key) {
+                    std::swap(x, y);
+                }
+                link(y, x);
+                degreeTable[d] = nullptr;
+                d++;
+            }
+            degreeTable[d] = x;
+            maxDegree = std::max<std::size_t>(maxDegree, d);
+            w = next;
+        }
+        min = nullptr;
+        for (std::size_t d = 0; d <= maxDegree; d++) {
+            if (degreeTable[d]) {
+                addToRoot(degreeTable[d]);
+                degreeTable[d] = nullptr;
+            }
+        }
+    }
+
+    void cut(Node* x, Node* y) {
+        if (x->right == x) {
+            y->child = nullptr;
+        } else {
+            if (y->child == x) {
+                y->child = x->right;
+            }
+            unlink(x);
+        }
+        y->degree--;
+        addToRoot(x);
+    }
+
+    void cascadingCut(Node* y) {
+        for (auto z = y->parent; z; y = z, z = y->parent) {
+            if (!y->mark) {
+                y->mark = true;
+                return;
+            }
+            cut(y, z);
+        }
+    }
+
+public:
+    using Handle = Node*;
+
+    [[nodiscard]] bool isEmpty() const {
+        return n == 0;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return n;
+    }
+
+    Handle Insert(const T& key, V value) {
+        auto x = arena.allocate();
+        *x = Node {};
+        x->key = key;
+        x->value = std::move(value);
+        addToRoot(x);
+        n++;
+        return x;
+    }
+
+    [[nodiscard]] Handle getMinimum() const {
+        return min;
+    }
+
+    [[nodiscard]] static const T& key(Handle x) {
+        return x->key;
+    }
+
+    [[nodiscard]] static const V& value(Handle x) {
+        return x->value;
+    }
+
+    std::pair<T, V> ExtractMin() {
+        auto z = min;
+        assert(z);
+        if (auto c = z->child) {
+            auto curr = c;
+            do {
+                curr->parent = nullptr;
+                curr->mark = false;
+                curr = curr->right;
+            } while (curr != c);
+            // splice the whole child list into the root list next to z
+            auto zr = z->right;
+            auto cl = c->left;
+            z->right = c;
+            c->left = z;
+            cl->right = zr;
+            zr->left = cl;
+        }
+        if (z == z->right) {
+            min = nullptr;
+        } else {
+            min = z->right;
+            unlink(z);
+            consolidate();
+        }
+        n--;
+        std::pair<T, V> result {z->key, std::move(z->value)};
+        arena.deallocate(z);
+        return result;
+    }
+
+    void DecreaseKey(Handle x, const T& k) {
+        if (k > x->key) {
+            return;
+        }
+        x->key = k;
+        auto y = x->parent;
+        if (y && x->key < y->key) {
+            cut(x, y);
+            cascadingCut(y);
+        }
+        if (x->key < min->key) {
+            min = x;
+        }
+    }
+
+    void Delete(Handle x) {
+        if (auto y = x->parent) {
+            cut(x, y);
+            cascadingCut(y);
+        }
+        min = x;
+        ExtractMin();
+    }
+
+    // moves every node of other into this heap; handles from other stay valid
+    void Merge(ArenaFibonacciHeap& other) {
+        if (other.min) {
+            if (!min) {
+                min = other.min;
+            } else {
+                auto r = min->right;
+                auto ol = other.min->left;
+                min->right = other.min;
+                other.min->left = min;
+                ol->right = r;
+                r->left = ol;
+                if (other.min->key < min->key) {
+                    min = other.min;
+                }
+            }
+        }
+        n += other.n;
+        arena.splice(other.arena);
+        other.min = nullptr;
+        other.n = 0;
+    }
+};
+
+// two-pass pairing heap; a node's prev is its left sibling, or its parent if it is the first child
+template <arithmetic T, typename V>
+class PairingHeap {
+    struct Node {
+        Node* child = nullptr;
+        Node* next = nullptr;
+        Node* prev = nullptr;
+        T key {};
+        V value {};
+    };
+
+    Node* root = nullptr;
+    std::size_t n = 0;
+    SlabArena<Node> arena;
+    std::vector<Node*> pairs;
+
+    static Node* meld(Node* a, Node* b) {
+        if (!a) {
+            return b;
+        }
+        if (!b) {
+            return a;
+        }
+        if (b->key < a->key) {
+            std::swap(a, b);
+        }
+        b->prev = a;
+        b->next = a->child;
+        if (a->child) {
+            a->child->prev = b;
+        }
+        a->child = b;
+        a->next = nullptr;
+        a->prev = nullptr;
+        return a;
+    }
+
+public:
+    using Handle = Node*;
+
+    [[nodiscard]] bool isEmpty() const {
+        return n == 0;
+    }
+
+    Handle Insert(const T& key, V value) {
+        auto x = arena.allocate();
+        *x = Node {};
+        x->key = key;
+        x->value = std::move(value);
+        root = meld(root, x);
+        n++;
+        return x;
+    }
+
+    [[nodiscard]] Handle getMinimum() const {
+        return root;
+    }
+
+    std::pair<T, V> ExtractMin() {
+        auto z = root;
+        assert(z);
+        pairs.clear();
+        for (auto c = z->child; c; ) {
+            auto a = c;
+            auto b = c->next;
+            c = b ? b->next : nullptr;
+            pairs.push_back(meld(a, b));
+        }
+        root = nullptr;
+        for (auto it = pairs.rbegin(); it != pairs.rend(); ++it) {
+            root = meld(*it, root);
+        }
+        n--;
+        std::pair<T, V> result {z->key, std::move(z->value)};
+        arena.deallocate(z);
+        return result;
+    }
+
+    void DecreaseKey(Handle x, const T& k) {
+        if (k > x->key) {
+            return;
+        }
+        x->key = k;
+        if (x == root) {
+            return;
+        }
+        if (x->prev->child == x) {
+            x->prev->child = x->next;
+        } else {
+            x->prev->next = x->next;
+        }
+        if (x->next) {
+            x->next->prev = x->prev;
+        }
+        x->next = nullptr;
+        x->prev = nullptr;
+        root = meld(root, x);
+    }
+};
+
+template <typename Heap>
+void checkAgainstMultiset() {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::int64_t> keyDist(0, 1'000);
+    Heap H;
+    std::multiset<std::pair<std::int64_t, std::size_t>> S;
+    std::vector<typename Heap::Handle> handles;
+    std::vector<bool> alive;
+    for (std::size_t step = 0; step < 20'000; step++) {
+        std::size_t op = gen() % 3;
+        if (op == 0 || S.empty()) {
+            auto k = keyDist(gen);
+            handles.push_back(H.Insert(k, handles.size()));
+            alive.push_back(true);
+            S.insert({k, handles.size() - 1});
+        } else if (op == 1) {
+            auto [k, v] = H.ExtractMin();
+            assert(k == S.begin()->first);
+            S.erase(S.find({k, v}));
+            alive[v] = false;
+        } else {
+            std::size_t v = gen() % handles.size();
+            if (alive[v]) {
+                auto old = handles[v]->key;
+                auto k = old - keyDist(gen);
+                H.DecreaseKey(handles[v], k);
+                S.erase(S.find({old, v}));
+                S.insert({k, v});
+            }
+        }
+    }
+}
+
+struct Workload {
+    std::vector<std::int64_t> keys;
+    std::vector<std::size_t> targets;
+    std::vector<std::int64_t> deltas;
+};
+
+constexpr std::size_t DECREASES_PER_EXTRACT = 4;
+
+// every extract-min is followed by a few decrease-keys on random values, like a Dijkstra run
+template <typename Heap, typename Find>
+crn::microseconds runWorkload(const Workload& w, Find find) {
+    Heap H;
+    std::vector<bool> alive (w.keys.size(), true);
+    std::vector<typename Heap::Handle> handles;
+    auto t1 = crn::steady_clock::now();
+    for (std::size_t v = 0; v < w.keys.size(); v++) {
+        handles.push_back(H.Insert(w.keys[v], v));
+    }
+    std::size_t j = 0;
+    while (!H.isEmpty()) {
+        auto [k, v] = H.ExtractMin();
+        alive[v] = false;
+        for (std::size_t i = 0; i < DECREASES_PER_EXTRACT; i++, j++) {
+            auto target = w.targets[j];
+            if (alive[target]) {
+                auto x = find(H, handles, target);
+                H.DecreaseKey(x, x->key - w.deltas[j]);
+            }
+        }
+    }
+    auto t2 = crn::steady_clock::now();
+    return crn::duration_cast<crn::microseconds>(t2 - t1);
+}
+
+// the original heap has no handles; it is used the way it was meant to be, by value lookup
+template <arithmetic T, hashable V>
+class LegacyFibonacciHeap : public FibonacciHeap<T, V> {
+public:
+    using Handle = decltype(std::declval<FibonacciHeap<T, V>>().getMinimum());
+
+    Handle Insert(const T& key, const V& value) {
+        FibonacciHeap<T, V>::Insert(key, value);
+        return nullptr;
+    }
+
+    std::pair<T, V> ExtractMin() {
+        auto z = FibonacciHeap<T, V>::ExtractMin();
+        return {z->key, z->value};
+    }
+};
+
 int main() {
+    ArenaFibonacciHeap<int, int> H1, H2;
+    auto a = H1.Insert(5, 0);
+    H1.Insert(3, 1);
+    H2.Insert(4, 2);
+    auto d = H2.Insert(7, 3);
+    H1.Merge(H2);
+    H1.DecreaseKey(d, 1);
+    H1.Delete(a);
+    assert(H1.ExtractMin() == std::pair(1, 3));
+    assert(H1.ExtractMin() == std::pair(3, 1));
+    assert(H1.ExtractMin() == std::pair(4, 2));
+    assert(H1.isEmpty());
+
+    checkAgainstMultiset<ArenaFibonacciHeap<std::int64_t, std::size_t>>();
+    checkAgainstMultiset<PairingHeap<std::int64_t, std::size_t>>();
+
+    constexpr std::size_t N = 100'000;
+    std::mt19937 gen(std::random_device{}());
+    std::uniform_int_distribution<std::int64_t> keyDist(0, 1'000'000'000);
+    std::uniform_int_distribution<std::size_t> targetDist(0, N - 1);
+    std::uniform_int_distribution<std::int64_t> deltaDist(0, 1'000'000);
+    Workload w;
+    for (std::size_t i = 0; i < N; i++) {
+        w.keys.push_back(keyDist(gen));
+    }
+    for (std::size_t i = 0; i < N * DECREASES_PER_EXTRACT; i++) {
+        w.targets.push_back(targetDist(gen));
+        w.deltas.push_back(deltaDist(gen));
+    }
 
+    auto byHandle = [](auto&, auto& handles, std::size_t v) { return handles[v]; };
+    auto byValue = [](auto& H, auto&, std::size_t v) { return H.SearchByValue(v); };
+    std::cout << N << " extract-mins with " << DECREASES_PER_EXTRACT << " decrease-key attempts each\n";
+    std::cout << "  Fibonacci heap (node per allocation, hash lookup) : "
+              << runWorkload<LegacyFibonacciHeap<std::int64_t, std::size_t>>(w, byValue).count() << "us\n";
+    std::cout << "  Fibonacci heap (slab arena, handles) : "
+              << runWorkload<ArenaFibonacciHeap<std::int64_t, std::size_t>>(w, byHandle).count() << "us\n";
+    std::cout << "  Pairing heap (slab arena, handles) : "
+              << runWorkload<PairingHeap<std::int64_t, std::size_t>>(w, byHandle).count() << "us\n";
 }
\ No newline at end of file
@@ -1,46 +1,203 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
+#include <random>
+#include <utility>
 #include <vector>
+#include <ranges>
+
+namespace sr = std::ranges;
+namespace crn = std::chrono;
+
+std::mt19937 gen(std::random_device{}());
+
+constexpr size_t INSERTION_SORT_CUTOFF = 32;
+constexpr size_t MIN_GALLOP = 7;
 
 template <typename T>
-void merge(std::vector<T>& A, size_t p, size_t q, size_t r) {
-    size_t i = p;
-    size_t j = q;
-    std::vector<T> B (r - p);
-    for (size_t k = 0; k < B.size(); k++) {
-        if (A[i] < A[j] || j >= r) {
-            B[k] = A[i];
-            i++;
-        } else {
-            B[k] = A[j];
-            j++;
+void insertionSort(std::vector<T>& A, size_t p, size_t r) {
+    for (size_t j = p + 1; j < r; j++) {
+        T key = std::move(A[j]);
+        size_t i = j;
+        while (i > p && key < A[i - 1]) {
+            A[i] = std::move(A[i - 1]);
+            i--;
         }
+        A[i] = std::move(key);
+    }
+}
+
+// first index in [p, r) whose element is greater than key
+template <typename T>
+size_t gallopRight(const std::vector<T>& A, size_t p, size_t r, const T& key) {
+    size_t lo = p;
+    size_t step = 1;
+    while (step <= r - lo && !(key < A[lo + step - 1])) {
+        lo += step;
+        step *= 2;
     }
-    std::copy(A.begin() + p, A.begin() + r, B.begin());
+    size_t hi = lo + std::min(step, r - lo);
+    return std::upper_bound(A.begin() + lo, A.begin() + hi, key) - A.begin();
 }
 
+// first index in [p, r) whose element is not less than key
 template <typename T>
-void mergeSortHelper(std::vector<T>& A, size_t p, size_t r) {
-    if (p < r) {
-        size_t q = p + (r - p) / 2;
-        mergeSortHelper(A, p, q);
-        mergeSortHelper(A, q + 1, r);
-        merge(A, p, q, r);
+size_t gallopLeft(const std::vector<T>& A, size_t p, size_t r, const T& key) {
+    size_t lo = p;
+    size_t step = 1;
+    while (step <= r - lo && A[lo + step - 1] < key) {
+        lo += step;
+        step *= 2;
+    }
+    size_t hi = lo + std::min(step, r - lo);
+    return std::lower_bound(A.begin() + lo, A.begin() + hi, key) - A.begin();
+}
+
+// merges src[p, q) and src[q, r) into dst[p, r)
+template <typename T>
+void merge(std::vector<T>& src, std::vector<T>& dst, size_t p, size_t q, size_t r) {
+    if (!(src[q] < src[q - 1])) {
+        std::move(src.begin() + p, src.begin() + r, dst.begin() + p);
+        return;
+    }
+    if (src[r - 1] < src[p]) {
+        auto out = std::move(src.begin() + q, src.begin() + r, dst.begin() + p);
+        std::move(src.begin() + p, src.begin() + q, out);
+        return;
+    }
+    size_t i = p;
+    size_t j = q;
+    size_t k = p;
+    size_t leftWins = 0;
+    size_t rightWins = 0;
+    while (i < q && j < r) {
+        if (src[j] < src[i]) {
+            dst[k++] = std::move(src[j++]);
+            leftWins = 0;
+            if (++rightWins >= MIN_GALLOP) {
+                size_t e = gallopLeft(src, j, r, src[i]);
+                k = std::move(src.begin() + j, src.begin() + e, dst.begin() + k) - dst.begin();
+                j = e;
+                rightWins = 0;
+            }
+        } else {
+            dst[k++] = std::move(src[i++]);
+            rightWins = 0;
+            if (++leftWins >= MIN_GALLOP && j < r) {
+                size_t e = gallopRight(src, i, q, src[j]);
+                k = std::move(src.begin() + i, src.begin() + e, dst.begin() + k) - dst.begin();
+                i = e;
+                leftWins = 0;
+            }
+        }
     }
+    k = std::move(src.begin() + i, src.begin() + q, dst.begin() + k) - dst.begin();
+    std::move(src.begin() + j, src.begin() + r, dst.begin() + k);
 }
 
 template <typename T>
 void mergeSort(std::vector<T>& A) {
-    mergeSortHelper(A, 0, A.size() - 1);
+    size_t n = A.size();
+    for (size_t p = 0; p < n; p += INSERTION_SORT_CUTOFF) {
+        insertionSort(A, p, std::min(p + INSERTION_SORT_CUTOFF, n));
+    }
+    if (n <= INSERTION_SORT_CUTOFF) {
+        return;
+    }
+    std::vector<T> B (n);
+    std::vector<T>* src = &A;
+    std::vector<T>* dst = &B;
+    for (size_t width = INSERTION_SORT_CUTOFF; width < n; width *= 2) {
+        for (size_t p = 0; p < n; p += 2 * width) {
+            size_t q = std::min(p + width, n);
+            size_t r = std::min(p + 2 * width, n);
+            if (q < r) {
+                merge(*src, *dst, p, q, r);
+            } else {
+                std::move(src->begin() + p, src->begin() + r, dst->begin() + p);
+            }
+        }
+        std::swap(src, dst);
+    }
+    if (src != &A) {
+        A.swap(B);
+    }
 }
 
+struct Record {
+    int key;
+    size_t id;
+    bool operator<(const Record& other) const {
+        return key < other.key;
+    }
+};
+
 int main() {
     std::vector<int> v {5, 4, 3, 2, 1};
     mergeSort(v);
-    for (auto n : v) {
-        std::cout << n << ' ';
+    assert(sr::is_sorted(v));
+
+    for (size_t n = 0; n < 300; n++) {
+        std::vector<int> u (n);
+        std::uniform_int_distribution<> dist(0, 50);
+        for (auto& x : u) {
+            x = dist(gen);
+        }
+        auto w = u;
+        mergeSort(u);
+        sr::sort(w);
+        assert(u == w);
     }
 
+    std::vector<Record> R (10'000);
+    std::uniform_int_distribution<> keyDist(0, 100);
+    for (size_t i = 0; i < R.size(); i++) {
+        R[i] = {keyDist(gen), i};
+    }
+    mergeSort(R);
+    for (size_t i = 1; i < R.size(); i++) {
+        assert(R[i - 1].key < R[i].key || (R[i - 1].key == R[i].key && R[i - 1].id < R[i].id));
+    }
+
+    constexpr size_t N = 1'000'000;
+    constexpr size_t TRIALS = 10;
+    std::vector<int> random (N);
+    std::uniform_int_distribution<> dist;
+    for (auto& x : random) {
+        x = dist(gen);
+    }
+    auto sorted = random;
+    sr::sort(sorted);
+    auto reversed = sorted;
+    sr::reverse(reversed);
+    auto nearlySorted = sorted;
+    std::uniform_int_distribution<size_t> idx(0, N - 1);
+    for (size_t i = 0; i < N / 100; i++) {
+        std::swap(nearlySorted[idx(gen)], nearlySorted[idx(gen)]);
+    }
+
+    std::pair<const char*, const std::vector<int>*> inputs[] = {
+        {"random", &random}, {"sorted", &sorted}, {"reversed", &reversed}, {"nearly sorted", &nearlySorted}
+    };
+    for (auto [name, input] : inputs) {
+        crn::microseconds DT1(0), DT2(0);
+        for (size_t t = 0; t < TRIALS; t++) {
+            auto u = *input;
+            auto t1 = crn::steady_clock::now();
+            mergeSort(u);
+            auto t2 = crn::steady_clock::now();
+            DT1 += crn::duration_cast<crn::microseconds>(t2 - t1);
+            assert(sr::is_sorted(u));
+
+            u = *input;
+            auto t3 = crn::steady_clock::now();
+            std::stable_sort(u.begin(), u.end());
+            auto t4 = crn::steady_clock::now();
+            DT2 += crn::duration_cast<crn::microseconds>(t4 - t3);
+        }
+        std::cout << "Bottom-up merge sort on " << N << " " << name << " elements : " << DT1.count() / TRIALS << "us\n";
+        std::cout << "std::stable_sort on " << N << " " << name << " elements : " << DT2.count() / TRIALS << "us\n";
+    }
 
 }
\ No newline at end of file
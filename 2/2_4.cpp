@@ -1,7 +1,15 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
+#include <random>
 #include <vector>
+#include <ranges>
+
+namespace sr = std::ranges;
+namespace crn = std::chrono;
+
+std::mt19937 gen(std::random_device{}());
 
 template <typename T>
 size_t merge(std::vector<T>& A, size_t p, size_t q, size_t r) {
@@ -11,7 +19,7 @@ size_t merge(std::vector<T>& A, size_t p, size_t q, size_t r) {
     std::vector<T> B (1 + r - p);
     size_t k = 0;
     while (i < q && j <= r) {
-        if (A[i] < A[j]) {
+        if (!(A[j] < A[i])) {
             B[k++] = A[i++];
         } else {
             B[k++] = A[j++];
@@ -42,14 +50,255 @@ size_t inversionsHelper(std::vector<T>& A, size_t p, size_t r) {
 }
 
 template <typename T>
-size_t inversions(std::vector<T>& A) {
+size_t topDownInversions(std::vector<T>& A) {
+    if (A.empty()) {
+        return 0;
+    }
     return inversionsHelper(A, 0, A.size() - 1);
 }
 
+struct InversionStats {
+    size_t inversions = 0;
+    size_t runs = 0;
+    size_t merges = 0;
+    size_t gallops = 0;
+};
+
+template <typename T>
+class RunMerger {
+    static constexpr size_t MIN_GALLOP = 7;
+
+    struct Run {
+        size_t base;
+        size_t len;
+    };
+
+    std::vector<T>& A;
+    std::vector<T> tmp;
+    std::vector<Run> runs;
+    InversionStats stats;
+
+    static size_t minRunLength(size_t n) {
+        size_t r = 0;
+        while (n >= 64) {
+            r |= n & 1;
+            n >>= 1;
+        }
+        return n + r;
+    }
+
+    // first index in [p, r) whose element is greater than key
+    size_t gallopRight(size_t p, size_t r, const T& key) const {
+        size_t lo = p;
+        size_t step = 1;
+        while (step <= r - lo && !(key < A[lo + step - 1])) {
+            lo += step;
+            step *= 2;
+        }
+        size_t hi = lo + std::min(step, r - lo);
+        return std::upper_bound(A.begin() + lo, A.begin() + hi, key) - A.begin();
+    }
+
+    // first index in [p, r) whose element is not less than key
+    size_t gallopLeft(size_t p, size_t r, const T& key) const {
+        size_t lo = p;
+        size_t step = 1;
+        while (step <= r - lo && A[lo + step - 1] < key) {
+            lo += step;
+            step *= 2;
+        }
+        size_t hi = lo + std::min(step, r - lo);
+        return std::lower_bound(A.begin() + lo, A.begin() + hi, key) - A.begin();
+    }
+
+    // returns the end of the natural run starting at p, reversing descending runs in place
+    size_t countRun(size_t p, size_t n) {
+        size_t r = p + 1;
+        if (r == n) {
+            return r;
+        }
+        if (A[r] < A[p]) {
+            while (r + 1 < n && A[r + 1] < A[r]) {
+                r++;
+            }
+            r++;
+            size_t len = r - p;
+            stats.inversions += len * (len - 1) / 2;
+            std::reverse(A.begin() + p, A.begin() + r);
+        } else {
+            while (r + 1 < n && !(A[r + 1] < A[r])) {
+                r++;
+            }
+            r++;
+        }
+        return r;
+    }
+
+    // extends the sorted prefix A[p, s) to A[p, r), counting each shift as one inversion
+    void insertionSort(size_t p, size_t s, size_t r) {
+        for (size_t j = s; j < r; j++) {
+            T key = std::move(A[j]);
+            size_t i = j;
+            while (i > p && key < A[i - 1]) {
+                A[i] = std::move(A[i - 1]);
+                i--;
+            }
+            stats.inversions += j - i;
+            A[i] = std::move(key);
+        }
+    }
+
+    void mergeAt(size_t idx) {
+        stats.merges++;
+        size_t p = runs[idx].base;
+        size_t q = p + runs[idx].len;
+        size_t r = q + runs[idx + 1].len;
+        runs[idx].len += runs[idx + 1].len;
+        runs.erase(runs.begin() + idx + 1);
+
+        p = gallopRight(p, q, A[q]);
+        if (p == q) {
+            return;
+        }
+        r = gallopLeft(q, r, A[q - 1]);
+
+        tmp.assign(std::make_move_iterator(A.begin() + p), std::make_move_iterator(A.begin() + q));
+        size_t leftLen = q - p;
+        size_t i = 0;
+        size_t j = q;
+        size_t k = p;
+        size_t leftWins = 0;
+        size_t rightWins = 0;
+        while (i < leftLen && j < r) {
+            if (A[j] < tmp[i]) {
+                A[k++] = std::move(A[j++]);
+                stats.inversions += leftLen - i;
+                leftWins = 0;
+                if (++rightWins >= MIN_GALLOP) {
+                    stats.gallops++;
+                    size_t e = gallopLeft(j, r, tmp[i]);
+                    stats.inversions += (e - j) * (leftLen - i);
+                    k = std::move(A.begin() + j, A.begin() + e, A.begin() + k) - A.begin();
+                    j = e;
+                    rightWins = 0;
+                }
+            } else {
+                A[k++] = std::move(tmp[i++]);
+                rightWins = 0;
+                if (++leftWins >= MIN_GALLOP && i < leftLen) {
+                    stats.gallops++;
+                    size_t e = std::upper_bound(tmp.begin() + i, tmp.begin() + leftLen, A[j]) - tmp.begin();
+                    k = std::move(tmp.begin() + i, tmp.begin() + e, A.begin() + k) - A.begin();
+                    i = e;
+                    leftWins = 0;
+                }
+            }
+        }
+        std::move(tmp.begin() + i, tmp.begin() + leftLen, A.begin() + k);
+    }
+
+    void mergeCollapse() {
+        while (runs.size() > 1) {
+            size_t n = runs.size() - 2;
+            if ((n > 0 && runs[n - 1].len <= runs[n].len + runs[n + 1].len) ||
+                (n > 1 && runs[n - 2].len <= runs[n - 1].len + runs[n].len)) {
+                if (runs[n - 1].len < runs[n + 1].len) {
+                    n--;
+                }
+            } else if (runs[n].len > runs[n + 1].len) {
+                break;
+            }
+            mergeAt(n);
+        }
+    }
+
+public:
+    explicit RunMerger(std::vector<T>& A) : A {A} {}
+
+    InversionStats sort() {
+        size_t n = A.size();
+        size_t minRun = minRunLength(n);
+        size_t p = 0;
+        while (p < n) {
+            size_t s = countRun(p, n);
+            stats.runs++;
+            size_t r = std::min(p + minRun, n);
+            if (s < r) {
+                insertionSort(p, s, r);
+            } else {
+                r = s;
+            }
+            runs.push_back({p, r - p});
+            mergeCollapse();
+            p = r;
+        }
+        while (runs.size() > 1) {
+            size_t n = runs.size() - 2;
+            if (n > 0 && runs[n - 1].len < runs[n + 1].len) {
+                n--;
+            }
+            mergeAt(n);
+        }
+        return stats;
+    }
+};
+
+template <typename T>
+InversionStats inversionStats(std::vector<T>& A) {
+    return RunMerger<T>(A).sort();
+}
+
+template <typename T>
+size_t inversions(std::vector<T>& A) {
+    return inversionStats(A).inversions;
+}
 
 int main() {
     std::vector<int> v {5, 4, 3, 2, 1};
-    std::cout << inversions(v);
+    assert(inversions(v) == 10);
+    assert(sr::is_sorted(v));
 
+    for (size_t n = 0; n < 500; n += 7) {
+        std::vector<int> u (n);
+        std::uniform_int_distribution<> dist(0, 30);
+        for (auto& x : u) {
+            x = dist(gen);
+        }
+        auto w = u;
+        assert(inversions(u) == topDownInversions(w));
+        assert(u == w);
+    }
+
+    constexpr size_t N = 1'000'000;
+    std::vector<int> nearlySorted (N);
+    for (size_t i = 0; i < N; i++) {
+        nearlySorted[i] = static_cast<int>(i);
+    }
+    std::uniform_int_distribution<size_t> idx(0, N - 1);
+    for (size_t i = 0; i < 100; i++) {
+        std::swap(nearlySorted[idx(gen)], nearlySorted[idx(gen)]);
+    }
+    std::vector<int> random (N);
+    std::uniform_int_distribution<> dist;
+    for (auto& x : random) {
+        x = dist(gen);
+    }
+
+    std::pair<const char*, const std::vector<int>*> inputs[] = {{"nearly sorted", &nearlySorted}, {"random", &random}};
+    for (auto [name, input] : inputs) {
+        auto u = *input;
+        auto w = *input;
+        auto t1 = crn::steady_clock::now();
+        auto stats = inversionStats(u);
+        auto t2 = crn::steady_clock::now();
+        size_t expected = topDownInversions(w);
+        auto t3 = crn::steady_clock::now();
+        assert(stats.inversions == expected);
+        std::cout << "Natural-run inversion count on " << N << " " << name << " elements : "
+                  << crn::duration_cast<crn::microseconds>(t2 - t1).count() << "us ("
+                  << stats.runs << " runs, " << stats.merges << " merges, " << stats.gallops << " gallops)\n";
+        std::cout << "Top-down inversion count on " << N << " " << name << " elements : "
+                  << crn::duration_cast<crn::microseconds>(t3 - t2).count() << "us\n";
+    }
 
 }
\ No newline at end of file
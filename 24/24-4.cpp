@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <array>
+#include <bit>
 #include <cassert>
 #include <chrono>
 #include <cmath>
@@ -10,12 +11,14 @@
 #include <limits>
 #include <list>
 #include <memory>
+#include <numbers>
 #include <numeric>
 #include <queue>
 #include <random>
 #include <ranges>
 #include <stack>
 #include <tuple>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -39,9 +42,6 @@ std::mt19937 gen(std::random_device{}());
 std::uniform_int_distribution<> dist(1, std::pow(2, W) - 1);
 std::bernoulli_distribution d(0.01);
 
-std::array<std::size_t, V * V> w = {0};
-std::array<std::size_t, V * V> curr_w = {0};
-
 template <arithmetic T, hashable V>
 class FibonacciHeap {
     struct Node {
@@ -102,8 +102,13 @@ class FibonacciHeap {
         x->degree++;
     }
 
+    // a node of degree k roots at least F(k+2) >= phi^k nodes
+    static std::size_t maxDegree(std::size_t n) {
+        return static_cast<std::size_t>(std::log(static_cast<double>(n)) / std::log(std::numbers::phi)) + 1;
+    }
+
     void Consolidate() {
-        std::vector<Node*> A (n + 1, nullptr);
+        std::vector<Node*> A (maxDegree(n) + 1, nullptr);
         std::vector<Node*> roots;
         auto curr = min;
         if (curr) {
@@ -127,7 +132,7 @@ class FibonacciHeap {
             A[d] = x;
         }
         min = nullptr;
-        for (std::size_t i = 0; i <= n; i++) {
+        for (std::size_t i = 0; i < A.size(); i++) {
             if (A[i]) {
                 addToRoot(A[i]);
             }
@@ -269,6 +274,218 @@ public:
     }
 };
 
+// hands out nodes from fixed-size slabs so their addresses never change; freed nodes are reused
+template <typename Node, std::size_t SlabSize = 1024>
+class SlabArena {
+    std::vector<std::unique_ptr<Node[]>> slabs;
+    std::size_t used = SlabSize;
+    std::vector<Node*> freeList;
+
+public:
+    Node* allocate() {
+        if (!freeList.empty()) {
+            auto x = freeList.back();
+            freeList.pop_back();
+            return x;
+        }
+        if (used == SlabSize) {
+            slabs.push_back(std::make_unique<Node[]>(SlabSize));
+            used = 0;
+        }
+        return &slabs.back()[used++];
+    }
+
+    void deallocate(Node* x) {
+        freeList.push_back(x);
+    }
+};
+
+// two-pass pairing heap; a node's prev is its left sibling, or its parent if it is the first child
+template <arithmetic T, typename V>
+class PairingHeap {
+    struct Node {
+        Node* child = nullptr;
+        Node* next = nullptr;
+        Node* prev = nullptr;
+        T key {};
+        V value {};
+    };
+
+    Node* root = nullptr;
+    std::size_t n = 0;
+    SlabArena<Node> arena;
+    std::vector<Node*> pairs;
+
+    static Node* meld(Node* a, Node* b) {
+        if (!a) {
+            return b;
+        }
+        if (!b) {
+            return a;
+        }
+        if (b->key < a->key) {
+            std::swap(a, b);
+        }
+        b->prev = a;
+        b->next = a->child;
+        if (a->child) {
+            a->child->prev = b;
+        }
+        a->child = b;
+        a->next = nullptr;
+        a->prev = nullptr;
+        return a;
+    }
+
+public:
+    using Handle = Node*;
+
+    [[nodiscard]] bool isEmpty() const {
+        return n == 0;
+    }
+
+    Handle Insert(const T& key, V value) {
+        auto x = arena.allocate();
+        *x = Node {};
+        x->key = key;
+        x->value = std::move(value);
+        root = meld(root, x);
+        n++;
+        return x;
+    }
+
+    std::pair<T, V> ExtractMin() {
+        auto z = root;
+        assert(z);
+        pairs.clear();
+        for (auto c = z->child; c; ) {
+            auto a = c;
+            auto b = c->next;
+            c = b ? b->next : nullptr;
+            pairs.push_back(meld(a, b));
+        }
+        root = nullptr;
+        for (auto it = pairs.rbegin(); it != pairs.rend(); ++it) {
+            root = meld(*it, root);
+        }
+        n--;
+        std::pair<T, V> result {z->key, std::move(z->value)};
+        arena.deallocate(z);
+        return result;
+    }
+
+    void DecreaseKey(Handle x, const T& k) {
+        if (k > x->key) {
+            return;
+        }
+        x->key = k;
+        if (x == root) {
+            return;
+        }
+        if (x->prev->child == x) {
+            x->prev->child = x->next;
+        } else {
+            x->prev->next = x->next;
+        }
+        if (x->next) {
+            x->next->prev = x->prev;
+        }
+        x->next = nullptr;
+        x->prev = nullptr;
+        root = meld(root, x);
+    }
+};
+
+// monotone priority queue for unsigned keys: bucket i holds keys that first differ from the last
+// extracted key at bit i - 1, so every key is redistributed at most once per bit
+template <std::unsigned_integral T, typename V>
+class RadixHeap {
+    std::array<std::vector<std::pair<T, V>>, std::numeric_limits<T>::digits + 1> buckets;
+    T last = 0;
+    std::size_t n = 0;
+
+    std::size_t bucketIndex(T key) const {
+        return std::bit_width(static_cast<T>(key ^ last));
+    }
+
+public:
+    [[nodiscard]] bool isEmpty() const {
+        return n == 0;
+    }
+
+    void Insert(const T& key, V value) {
+        assert(key >= last);
+        buckets[bucketIndex(key)].emplace_back(key, std::move(value));
+        n++;
+    }
+
+    std::pair<T, V> ExtractMin() {
+        assert(n > 0);
+        if (buckets[0].empty()) {
+            std::size_t i = 1;
+            while (buckets[i].empty()) {
+                i++;
+            }
+            last = sr::min_element(buckets[i])->first;
+            for (auto& x : buckets[i]) {
+                buckets[bucketIndex(x.first)].push_back(std::move(x));
+            }
+            buckets[i].clear();
+        }
+        auto x = std::move(buckets[0].back());
+        buckets[0].pop_back();
+        n--;
+        return x;
+    }
+};
+
+// queue policies for DijkstraWith: push(v, d) queues v at distance d or lowers its key,
+// pop() returns some closest queued (distance, vertex), possibly a stale one
+template <arithmetic T>
+class PairingQueue {
+    PairingHeap<T, std::size_t> Q;
+    std::vector<typename PairingHeap<T, std::size_t>::Handle> handles;
+
+public:
+    explicit PairingQueue(std::size_t n) : handles(n, nullptr) {}
+
+    [[nodiscard]] bool empty() const {
+        return Q.isEmpty();
+    }
+
+    void push(std::size_t v, T d) {
+        if (handles[v]) {
+            Q.DecreaseKey(handles[v], d);
+        } else {
+            handles[v] = Q.Insert(d, v);
+        }
+    }
+
+    std::pair<T, std::size_t> pop() {
+        return Q.ExtractMin();
+    }
+};
+
+template <std::unsigned_integral T>
+class RadixQueue {
+    RadixHeap<T, std::size_t> Q;
+
+public:
+    explicit RadixQueue(std::size_t) {}
+
+    [[nodiscard]] bool empty() const {
+        return Q.isEmpty();
+    }
+
+    void push(std::size_t v, T d) {
+        Q.Insert(d, v);
+    }
+
+    std::pair<T, std::size_t> pop() {
+        return Q.ExtractMin();
+    }
+};
+
 template <std::size_t n, arithmetic T = double, bool undirected = false>
 class Graph {
     std::vector<std::list<std::pair<std::size_t, T>>> adj;
@@ -333,7 +550,7 @@ public:
         }
     }
 
-    void Dijkstra(std::size_t s) {
+    std::vector<T> Dijkstra(std::size_t s) {
         FibonacciHeap<T, std::size_t> Q;
         InitializeSingleSource(Q, s);
 
@@ -348,14 +565,10 @@ public:
                 Relax(Q, u, ud, v, dists);
             }
         }
-
-        for (auto dist_ : dists) {
-            std::cout << dist_ << ' ';
-        }
-        std::cout << '\n';
+        return dists;
     }
 
-    void DijkstraPQ(std::size_t s) {
+    std::vector<T> DijkstraPQ(std::size_t s) {
         std::priority_queue<std::pair<T, std::size_t>, std::vector<std::pair<T, std::size_t>>, std::greater<>> Q;
         Q.emplace(0.0, s);
 
@@ -372,100 +585,171 @@ public:
                 }
             }
         }
+        return dists;
+    }
 
-        for (auto dist_ : dists) {
-            std::cout << dist_ << ' ';
+    template <template <typename> typename Queue>
+    std::vector<T> DijkstraWith(std::size_t s) {
+        Queue<T> Q (n);
+        Q.push(s, T{0});
+
+        std::vector<T> dists (n, std::numeric_limits<T>::max());
+        dists[s] = T{0};
+
+        while (!Q.empty()) {
+            auto [d, u] = Q.pop();
+            if (d > dists[u]) {
+                continue;
+            }
+            for (const auto& [v, w_] : adj[u]) {
+                if (dists[v] > d + w_) {
+                    dists[v] = d + w_;
+                    Q.push(v, dists[v]);
+                }
+            }
         }
-        std::cout << '\n';
+        return dists;
     }
 
-    std::vector<T> DijkstraArray(std::size_t s, std::size_t E) {
-        std::vector<std::list<std::size_t>> Q (E + 2);
+    // edges of u occupy [offsets[u], offsets[u + 1]) in adjacency order
+    [[nodiscard]] std::vector<std::size_t> edgeOffsets() const {
+        std::vector<std::size_t> offsets (n + 1, 0);
+        for (std::size_t u = 0; u < n; u++) {
+            offsets[u + 1] = offsets[u] + adj[u].size();
+        }
+        return offsets;
+    }
+
+    // Dial's algorithm with cw[e] as the weight of edge e; all keys in the queue lie in
+    // [min_val, min_val + C], so C + 1 buckets used as a ring are enough
+    std::vector<std::size_t> DijkstraArray(std::size_t s, const std::vector<std::size_t>& offsets,
+                                           const std::vector<std::size_t>& cw) {
+        std::size_t C = cw.empty() ? 0 : *sr::max_element(cw);
+        std::vector<std::vector<std::size_t>> Q (C + 1);
 
         std::size_t min_val = 0;
+        std::size_t pending = 1;
 
-        std::vector<T> dists (n, E + 1);
-        dists[s] = T{0};
+        std::vector<std::size_t> dists (n, std::numeric_limits<std::size_t>::max());
+        dists[s] = 0;
         Q[0].push_back(s);
-        while (!sr::all_of(Q, [](const auto& l){return l.empty();})) {
-            min_val = std::distance(Q.begin(),
-                                    std::find_if(Q.begin() + min_val, Q.end(), [](const auto &l) { return !l.empty(); }));
-            auto u = Q[min_val].front();
-            Q[min_val].pop_front();
+        while (pending) {
+            while (Q[min_val % (C + 1)].empty()) {
+                min_val++;
+            }
+            auto& bucket = Q[min_val % (C + 1)];
+            auto u = bucket.back();
+            bucket.pop_back();
+            pending--;
+            if (dists[u] != min_val) {
+                continue;
+            }
+            auto e = offsets[u];
             for (const auto& [v, _] : adj[u]) {
-                if (dists[v] > min_val + curr_w[u * n + v]) {
-                    dists[v] = min_val + curr_w[u * n + v];
-                    Q[dists[v]].push_back(v);
+                if (dists[v] > min_val + cw[e]) {
+                    dists[v] = min_val + cw[e];
+                    Q[dists[v] % (C + 1)].push_back(v);
+                    pending++;
                 }
+                e++;
             }
         }
         return dists;
     }
 
-    void DijkstraGabow(std::size_t s, std::size_t E) {
-
+    std::vector<std::size_t> DijkstraArray(std::size_t s) {
+        auto offsets = edgeOffsets();
+        std::vector<std::size_t> cw;
+        cw.reserve(offsets[n]);
         for (std::size_t u = 0; u < n; u++) {
-            for (const auto& [v, _] : adj[u]) {
-                curr_w[u * n + v] = w[u * n + v] / std::pow(2, W - 1);
+            for (const auto& [_, w_] : adj[u]) {
+                cw.push_back(w_);
+            }
+        }
+        return DijkstraArray(s, offsets, cw);
+    }
+
+    std::vector<std::size_t> DijkstraGabow(std::size_t s) {
+        constexpr auto inf = std::numeric_limits<std::size_t>::max();
+        auto offsets = edgeOffsets();
+        std::vector<std::size_t> cw (offsets[n]);
+
+        for (std::size_t u = 0, e = 0; u < n; u++) {
+            for (const auto& [_, w_] : adj[u]) {
+                cw[e++] = w_ >> (W - 1);
             }
         }
-        auto dists = DijkstraArray(s, E);
+        auto dists = DijkstraArray(s, offsets, cw);
         for (std::size_t i = 1; i < W; i++) {
-            for (std::size_t u = 0; u < n; u++) {
-                for (const auto& [v, _] : adj[u]) {
-                    curr_w[u * n + v] = w[u * n + v] / std::pow(2, W - (i + 1))
-                            + 2 * dists[u] - 2 * dists[v];
+            for (std::size_t u = 0, e = 0; u < n; u++) {
+                for (const auto& [v, w_] : adj[u]) {
+                    // edges out of unreachable vertices are never relaxed
+                    cw[e++] = dists[u] == inf ? 0 : (w_ >> (W - (i + 1))) + 2 * dists[u] - 2 * dists[v];
                 }
             }
-            auto dists_hat = DijkstraArray(s, E);
+            auto dists_hat = DijkstraArray(s, offsets, cw);
             for (std::size_t u = 0; u < n; u++) {
-                dists[u] = dists_hat[u] + 2 * dists[u];
+                if (dists[u] != inf) {
+                    dists[u] = dists_hat[u] + 2 * dists[u];
+                }
             }
         }
-
-        for (auto dist_ : dists) {
-            std::cout << dist_ << ' ';
-        }
-        std::cout << '\n';
+        return dists;
     }
 
 };
 
+template <typename F>
+auto timed(const char* name, F f) {
+    auto t1 = crn::steady_clock::now();
+    auto dists = f();
+    auto t2 = crn::steady_clock::now();
+    std::cout << "  " << name << " : " << crn::duration_cast<crn::milliseconds>(t2 - t1).count() << "ms\n";
+    return dists;
+}
+
+template <typename G>
+void compareAll(G& g) {
+    auto d1 = timed("Dijkstra with Fibonacci Heap", [&] { return g.Dijkstra(0); });
+    auto d2 = timed("Dijkstra with std::priority_queue", [&] { return g.DijkstraPQ(0); });
+    auto d3 = timed("Dijkstra with pairing heap", [&] { return g.template DijkstraWith<PairingQueue>(0); });
+    auto d4 = timed("Dijkstra with radix heap", [&] { return g.template DijkstraWith<RadixQueue>(0); });
+    auto d5 = timed("Dijkstra with bucket array", [&] { return g.DijkstraArray(0); });
+    auto d6 = timed("Dijkstra with Gabow's scaling", [&] { return g.DijkstraGabow(0); });
+    assert(d1 == d2 && d2 == d3 && d3 == d4 && d4 == d5 && d5 == d6);
+}
+
+constexpr std::size_t GRID = 1'000;
+
 int main() {
     Graph<V, std::size_t> g;
-    std::size_t E = 0;
     for (std::size_t i = 0; i < V; i++) {
         for (std::size_t j = i + 1; j < V; j++) {
             if (d(gen)) {
-                auto weight = dist(gen);
-                g.addEdge(i, j, weight);
-                w[i * V + j] = weight;
-                E++;
+                g.addEdge(i, j, dist(gen));
             }
             if (d(gen)) {
-                auto weight = dist(gen);
-                g.addEdge(j, i, weight);
-                w[j * V + i] = weight;
-                E++;
+                g.addEdge(j, i, dist(gen));
             }
         }
     }
-
-    auto t1 = crn::steady_clock::now();
-    g.Dijkstra(0);
-    auto t2 = crn::steady_clock::now();
-    auto dt1 = crn::duration_cast<crn::milliseconds>(t2 - t1);
-    std::cout << "Dijkstra with Fibonacci Heap : " << dt1.count() << "ms\n";
-    auto t3 = crn::steady_clock::now();
-    g.DijkstraPQ(0);
-    auto t4 = crn::steady_clock::now();
-    auto dt2 = crn::duration_cast<crn::milliseconds>(t4 - t3);
-    std::cout << "Dijkstra with std::priority_queue : " << dt2.count() << "ms\n";
-    auto t5 = crn::steady_clock::now();
-    g.DijkstraGabow(0, E);
-    auto t6 = crn::steady_clock::now();
-    auto dt3 = crn::duration_cast<crn::milliseconds>(t6 - t5);
-    std::cout << "Dijkstra with Gabow's scaling : " << dt3.count() << "ms\n";
-
-
+    std::cout << "Random graph on " << V << " vertices\n";
+    compareAll(g);
+
+    // 4-neighbour grid with a few missing streets, like a road network
+    auto grid = std::make_unique<Graph<GRID * GRID, std::size_t, true>>();
+    std::bernoulli_distribution missing(0.05);
+    for (std::size_t r = 0; r < GRID; r++) {
+        for (std::size_t c = 0; c < GRID; c++) {
+            auto u = r * GRID + c;
+            if (c + 1 < GRID && (r == 0 || !missing(gen))) {
+                grid->addEdge(u, u + 1, dist(gen));
+            }
+            if (r + 1 < GRID && (c == 0 || !missing(gen))) {
+                grid->addEdge(u, u + GRID, dist(gen));
+            }
+        }
+    }
+    std::cout << "Grid graph on " << GRID * GRID << " vertices\n";
+    compareAll(*grid);
 }
\ No newline at end of file
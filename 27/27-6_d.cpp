@@ -1,43 +1,304 @@
 #include <algorithm>
+#include <atomic>
 #include <cassert>
-#include <random>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
 #include <vector>
 #include <ranges>
 #include <thread>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
 
 std::mt19937 gen(std::random_device{}());
 
-template <typename T>
-size_t partition(std::vector<T>& A, size_t p, size_t r) {
-    T x = A[r];
-    size_t i = p;
-    for (size_t j = p; j < r; j++) {
-        if (A[j] <= x) {
-            std::swap(A[i], A[j]);
-            i++;
+// fixed set of workers, each owning a deque: the owner pushes and pops at the back,
+// idle workers steal from the front of someone else's deque
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(size_t threadCount = std::thread::hardware_concurrency()) {
+        threadCount = std::max<size_t>(threadCount, 1);
+        for (size_t i = 0; i < threadCount; i++) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        // the thread that waits on a task group acts as worker 0
+        for (size_t i = 1; i < threadCount; i++) {
+            threads.emplace_back([this, i](std::stop_token st) { workerLoop(st, i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        for (auto& t : threads) {
+            t.request_stop();
+        }
+        sleeping.notify_all();
+    }
+
+    size_t size() const {
+        return queues.size();
+    }
+
+    void push(Task task) {
+        auto& q = *queues[currentIndex()];
+        {
+            std::lock_guard lock(q.m);
+            q.tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1, std::memory_order_release);
+        sleeping.notify_one();
+    }
+
+    bool runOne() {
+        Task task;
+        if (pop(task) || steal(task)) {
+            task();
+            return true;
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    static thread_local const WorkStealingPool* currentPool;
+    static thread_local size_t currentWorker;
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::atomic<size_t> queued {0};
+    std::mutex sleepMutex;
+    std::condition_variable_any sleeping;
+    std::vector<std::jthread> threads;
+
+    size_t currentIndex() const {
+        return currentPool == this ? currentWorker : 0;
+    }
+
+    bool pop(Task& task) {
+        auto& q = *queues[currentIndex()];
+        std::lock_guard lock(q.m);
+        if (q.tasks.empty()) {
+            return false;
+        }
+        task = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        queued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool steal(Task& task) {
+        size_t self = currentIndex();
+        for (size_t k = 1; k < queues.size(); k++) {
+            auto& q = *queues[(self + k) % queues.size()];
+            std::unique_lock lock(q.m, std::try_to_lock);
+            if (!lock.owns_lock() || q.tasks.empty()) {
+                continue;
+            }
+            task = std::move(q.tasks.front());
+            q.tasks.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(std::stop_token st, size_t i) {
+        currentPool = this;
+        currentWorker = i;
+        while (!st.stop_requested()) {
+            if (!runOne()) {
+                std::unique_lock lock(sleepMutex);
+                sleeping.wait_for(lock, st, crn::milliseconds(1), [this] {
+                    return queued.load(std::memory_order_acquire) > 0;
+                });
+            }
+        }
+    }
+};
+
+thread_local const WorkStealingPool* WorkStealingPool::currentPool = nullptr;
+thread_local size_t WorkStealingPool::currentWorker = 0;
+
+// fork-join scope: wait() keeps executing pool tasks until everything spawned here has finished
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool {pool} {}
+
+    ~TaskGroup() {
+        wait();
+    }
+
+    template <typename F>
+    void run(F f) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        pool.push([this, f = std::move(f)] {
+            f();
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    void wait() {
+        while (pending.load(std::memory_order_acquire) > 0) {
+            if (!pool.runOne()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    WorkStealingPool& pool;
+    std::atomic<size_t> pending {0};
+};
+
+constexpr size_t SERIAL_CUTOFF = 4'096;
+constexpr size_t PARALLEL_PARTITION_CUTOFF = 1 << 20;
+constexpr size_t PARTITION_GRAIN = 1 << 16;
+
+// partitions A[p, r) so that elements satisfying pred come first, returning the split point
+template <typename T, typename Pred>
+size_t parallelPartition(WorkStealingPool& pool, std::vector<T>& A, size_t p, size_t r, Pred pred) {
+    size_t n = r - p;
+    size_t blocks = std::clamp<size_t>(n / PARTITION_GRAIN, 1, 4 * pool.size());
+    size_t blockSize = (n + blocks - 1) / blocks;
+    std::vector<size_t> trues (blocks);
+    {
+        TaskGroup g(pool);
+        for (size_t i = 0; i < blocks; i++) {
+            g.run([&, i] {
+                auto b = A.begin() + p + std::min(i * blockSize, n);
+                auto e = A.begin() + p + std::min((i + 1) * blockSize, n);
+                trues[i] = std::partition(b, e, pred) - b;
+            });
+        }
+    }
+    size_t mid = p + std::accumulate(trues.begin(), trues.end(), size_t {0});
+
+    // satisfying elements right of mid have to trade places with failing elements left of it
+    struct Interval {
+        size_t begin;
+        size_t end;
+    };
+    std::vector<Interval> misplacedTrue;
+    std::vector<Interval> misplacedFalse;
+    for (size_t i = 0; i < blocks; i++) {
+        size_t b = p + std::min(i * blockSize, n);
+        size_t e = p + std::min((i + 1) * blockSize, n);
+        size_t split = b + trues[i];
+        if (std::max(b, mid) < split) {
+            misplacedTrue.push_back({std::max(b, mid), split});
+        }
+        if (split < std::min(e, mid)) {
+            misplacedFalse.push_back({split, std::min(e, mid)});
+        }
+    }
+    auto prefix = [](const std::vector<Interval>& intervals) {
+        std::vector<size_t> sums {0};
+        for (auto [b, e] : intervals) {
+            sums.push_back(sums.back() + e - b);
         }
+        return sums;
+    };
+    auto trueSums = prefix(misplacedTrue);
+    auto falseSums = prefix(misplacedFalse);
+    size_t misplaced = trueSums.back();
+    assert(misplaced == falseSums.back());
+    if (misplaced == 0) {
+        return mid;
+    }
+
+    // the k-th misplaced position, counting across intervals
+    auto locate = [](const std::vector<Interval>& intervals, const std::vector<size_t>& sums, size_t k) {
+        size_t j = std::upper_bound(sums.begin(), sums.end(), k) - sums.begin() - 1;
+        return std::pair {j, intervals[j].begin + (k - sums[j])};
+    };
+    size_t chunks = std::clamp<size_t>(misplaced / PARTITION_GRAIN, 1, 4 * pool.size());
+    size_t chunkSize = (misplaced + chunks - 1) / chunks;
+    TaskGroup g(pool);
+    for (size_t c = 0; c < chunks; c++) {
+        g.run([&, c] {
+            size_t k = c * chunkSize;
+            size_t end = std::min(k + chunkSize, misplaced);
+            if (k >= end) {
+                return;
+            }
+            auto [ti, tpos] = locate(misplacedTrue, trueSums, k);
+            auto [fi, fpos] = locate(misplacedFalse, falseSums, k);
+            for (; k < end; k++) {
+                if (tpos == misplacedTrue[ti].end) {
+                    tpos = misplacedTrue[++ti].begin;
+                }
+                if (fpos == misplacedFalse[fi].end) {
+                    fpos = misplacedFalse[++fi].begin;
+                }
+                std::swap(A[tpos++], A[fpos++]);
+            }
+        });
+    }
+    return mid;
+}
+
+template <typename T, typename Pred>
+size_t partitionBy(WorkStealingPool& pool, std::vector<T>& A, size_t p, size_t r, Pred pred) {
+    if (r - p >= PARALLEL_PARTITION_CUTOFF) {
+        return parallelPartition(pool, A, p, r, pred);
     }
-    std::swap(A[i], A[r]);
-    return i;
+    return std::partition(A.begin() + p, A.begin() + r, pred) - A.begin();
+}
+
+std::mt19937& threadGen() {
+    thread_local std::mt19937 g(std::random_device{}());
+    return g;
 }
 
+// sorts A[p, r)
 template <typename T>
-size_t randomizedPartition(std::vector<T>& A, size_t p, size_t r) {
-    std::uniform_int_distribution<> dst (p, r);
-    size_t i = dst(gen);
-    std::swap(A[i], A[r]);
-    return partition(A, p, r);
+void PQuickSort(WorkStealingPool& pool, std::vector<T>& A, size_t p, size_t r) {
+    if (r - p <= SERIAL_CUTOFF) {
+        std::sort(A.begin() + p, A.begin() + r);
+        return;
+    }
+    std::uniform_int_distribution<size_t> dist(p, r - 1);
+    size_t a = dist(threadGen());
+    size_t b = dist(threadGen());
+    size_t c = dist(threadGen());
+    size_t m = A[a] < A[b] ? (A[b] < A[c] ? b : (A[a] < A[c] ? c : a))
+                           : (A[a] < A[c] ? a : (A[b] < A[c] ? c : b));
+    std::swap(A[m], A[r - 1]);
+    const T x = A[r - 1];
+
+    size_t q = partitionBy(pool, A, p, r - 1, [&x](const T& e) { return e < x; });
+    std::swap(A[q], A[r - 1]);
+    size_t s = q + 1;
+    // a lopsided split usually means many copies of the pivot; those are already in place
+    if (q - p < (r - p) / 16) {
+        s = partitionBy(pool, A, q + 1, r, [&x](const T& e) { return !(x < e); });
+    }
+
+    TaskGroup g(pool);
+    g.run([&pool, &A, p, q] { PQuickSort(pool, A, p, q); });
+    PQuickSort(pool, A, s, r);
+}
+
+WorkStealingPool& defaultPool() {
+    static WorkStealingPool pool;
+    return pool;
 }
 
 template <typename T>
 void PRandomizedQuickSort(std::vector<T>& A, size_t p, size_t r) {
     if (p < r && r < A.size()) {
-        size_t q = randomizedPartition(A, p, r);
-        std::jthread t (&PRandomizedQuickSort<T>, std::ref(A), p, q - 1);
-        PRandomizedQuickSort(A, q + 1, r);
+        PQuickSort(defaultPool(), A, p, r + 1);
     }
 }
 
@@ -45,4 +306,51 @@ int main() {
     std::vector<int> v {3, 2, 6, 1, 5, 4};
     PRandomizedQuickSort(v, 0, v.size() - 1);
     assert(sr::is_sorted(v));
+
+    {
+        WorkStealingPool pool(4);
+        for (size_t n : {0, 1, 5'000, 100'000, 3'000'000}) {
+            for (int range : {3, 1'000'000'000}) {
+                std::vector<int> u (n);
+                std::uniform_int_distribution<> dist(0, range);
+                for (auto& x : u) {
+                    x = dist(gen);
+                }
+                auto w = u;
+                PQuickSort(pool, u, 0, n);
+                sr::sort(w);
+                assert(u == w);
+            }
+        }
+    }
+
+    constexpr size_t N = 100'000'000;
+    std::vector<int> input (N);
+    std::uniform_int_distribution<> dist;
+    for (auto& x : input) {
+        x = dist(gen);
+    }
+
+    auto u = input;
+    auto t1 = crn::steady_clock::now();
+    sr::sort(u);
+    auto t2 = crn::steady_clock::now();
+    auto serial = crn::duration_cast<crn::microseconds>(t2 - t1);
+    std::cout << "std::sort on " << N << " elements : " << serial.count() << "us\n";
+
+    size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        WorkStealingPool pool(threads);
+        u = input;
+        auto t3 = crn::steady_clock::now();
+        PQuickSort(pool, u, 0, N);
+        auto t4 = crn::steady_clock::now();
+        assert(sr::is_sorted(u));
+        auto dt = crn::duration_cast<crn::microseconds>(t4 - t3);
+        std::cout << "Work-stealing quicksort with " << threads << " threads : " << dt.count() << "us (speedup "
+                  << static_cast<double>(serial.count()) / static_cast<double>(dt.count()) << "x)\n";
+        if (threads == maxThreads) {
+            break;
+        }
+    }
 }
\ No newline at end of file
@@ -1,6 +1,13 @@
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
 #include <chrono>
+#include <condition_variable>
+#include <cstdint>
 #include <execution>
+#include <functional>
+#include <mutex>
 #include <numeric>
 #include <iostream>
 #include <random>
@@ -54,6 +61,152 @@ void PMergeSort(std::vector<T>& A, std::size_t p, std::size_t r,
 }
 
 
+// fixed set of threads that run one parallelFor at a time; the calling thread joins in
+class ThreadPool {
+public:
+    explicit ThreadPool(std::size_t threadCount = std::thread::hardware_concurrency()) {
+        for (std::size_t i = 1; i < std::max<std::size_t>(threadCount, 1); i++) {
+            threads.emplace_back([this](std::stop_token st) { workerLoop(st); });
+        }
+    }
+
+    std::size_t size() const {
+        return threads.size() + 1;
+    }
+
+    // calls f(i) for every i in [0, count), handing out indices dynamically
+    void parallelFor(std::size_t count, std::function<void(std::size_t)> f) {
+        {
+            std::lock_guard lock(m);
+            job = std::move(f);
+            jobCount = count;
+            next = 0;
+            active = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+        runJob();
+        std::unique_lock lock(m);
+        done.wait(lock, [this] { return active == 0; });
+    }
+
+private:
+    std::mutex m;
+    std::condition_variable_any wake;
+    std::condition_variable done;
+    std::function<void(std::size_t)> job;
+    std::size_t jobCount = 0;
+    std::atomic<std::size_t> next {0};
+    std::size_t active = 0;
+    std::size_t generation = 0;
+    std::vector<std::jthread> threads;
+
+    void runJob() {
+        for (std::size_t i = next.fetch_add(1); i < jobCount; i = next.fetch_add(1)) {
+            job(i);
+        }
+    }
+
+    void workerLoop(std::stop_token st) {
+        std::size_t seen = 0;
+        while (true) {
+            {
+                std::unique_lock lock(m);
+                if (!wake.wait(lock, st, [&] { return generation != seen; })) {
+                    return;
+                }
+                seen = generation;
+            }
+            runJob();
+            std::lock_guard lock(m);
+            if (--active == 0) {
+                done.notify_all();
+            }
+        }
+    }
+};
+
+constexpr std::size_t SAMPLE_SORT_CUTOFF = 1 << 16;
+constexpr std::size_t BUCKET_TARGET = 1 << 15;
+constexpr std::size_t MAX_BUCKETS = 1 << 10;
+constexpr std::size_t OVERSAMPLING = 32;
+
+// lays out sorted splitters S[lo, hi) as an implicit search tree rooted at node i
+template <typename T>
+void buildSplitterTree(const std::vector<T>& S, std::vector<T>& tree, std::size_t i, std::size_t lo, std::size_t hi) {
+    if (lo < hi) {
+        std::size_t mid = lo + (hi - lo) / 2;
+        tree[i] = S[mid];
+        buildSplitterTree(S, tree, 2 * i, lo, mid);
+        buildSplitterTree(S, tree, 2 * i + 1, mid + 1, hi);
+    }
+}
+
+template <typename T>
+void PSampleSort(ThreadPool& pool, std::vector<T>& A) {
+    std::size_t n = A.size();
+    if (n < SAMPLE_SORT_CUTOFF) {
+        std::sort(A.begin(), A.end());
+        return;
+    }
+    std::size_t k = std::clamp(std::bit_ceil(n / BUCKET_TARGET), std::size_t {2}, MAX_BUCKETS);
+    std::size_t levels = std::countr_zero(k);
+
+    std::mt19937 sampleGen(std::random_device{}());
+    std::uniform_int_distribution<std::size_t> idx(0, n - 1);
+    std::vector<T> sample (k * OVERSAMPLING);
+    for (auto& s : sample) {
+        s = A[idx(sampleGen)];
+    }
+    std::sort(sample.begin(), sample.end());
+    std::vector<T> splitters (k - 1);
+    for (std::size_t i = 0; i + 1 < k; i++) {
+        splitters[i] = sample[(i + 1) * OVERSAMPLING];
+    }
+    std::vector<T> tree (k);
+    buildSplitterTree(splitters, tree, 1, 0, k - 1);
+
+    std::size_t blocks = 4 * pool.size();
+    std::size_t blockSize = (n + blocks - 1) / blocks;
+    std::vector<std::uint16_t> oracle (n);
+    std::vector<std::vector<std::size_t>> C (blocks, std::vector<std::size_t>(k));
+    pool.parallelFor(blocks, [&](std::size_t b) {
+        auto& c = C[b];
+        for (std::size_t i = b * blockSize; i < std::min(n, (b + 1) * blockSize); i++) {
+            std::size_t j = 1;
+            for (std::size_t l = 0; l < levels; l++) {
+                j = 2 * j + (tree[j] < A[i]);
+            }
+            oracle[i] = static_cast<std::uint16_t>(j - k);
+            c[j - k]++;
+        }
+    });
+
+    std::vector<std::size_t> bucketStart (k + 1);
+    std::size_t sum = 0;
+    for (std::size_t j = 0; j < k; j++) {
+        bucketStart[j] = sum;
+        for (auto& c : C) {
+            std::size_t count = c[j];
+            c[j] = sum;
+            sum += count;
+        }
+    }
+    bucketStart[k] = n;
+
+    std::vector<T> B (n);
+    pool.parallelFor(blocks, [&](std::size_t b) {
+        auto& c = C[b];
+        for (std::size_t i = b * blockSize; i < std::min(n, (b + 1) * blockSize); i++) {
+            B[c[oracle[i]]++] = std::move(A[i]);
+        }
+    });
+    pool.parallelFor(k, [&](std::size_t j) {
+        std::sort(B.begin() + bucketStart[j], B.begin() + bucketStart[j + 1]);
+    });
+    A.swap(B);
+}
+
 int main() {
     constexpr std::size_t N = 2'000;
 
@@ -92,5 +245,47 @@ int main() {
     auto dt5 = crn::duration_cast<crn::microseconds>(t10 - t9);
     std::cout << "std::sort (par) : " << dt5.count() << "us\n";
 
+    {
+        ThreadPool pool(3);
+        for (std::size_t n : {0, 1, 1'000, 100'000, 1'000'000}) {
+            std::vector<int> u (n);
+            std::uniform_int_distribution<> dist(0, n % 3 == 0 ? 100 : 1'000'000'000);
+            for (auto& x : u) {
+                x = dist(gen);
+            }
+            auto w = u;
+            PSampleSort(pool, u);
+            sr::sort(w);
+            assert(u == w);
+        }
+    }
+
+    constexpr std::size_t M = 20'000'000;
+    std::vector<std::uint64_t> keys (M);
+    std::uniform_int_distribution<std::uint64_t> keyDist;
+    for (auto& x : keys) {
+        x = keyDist(gen);
+    }
+    auto sorted = keys;
+    auto t11 = crn::steady_clock::now();
+    std::sort(sorted.begin(), sorted.end());
+    auto t12 = crn::steady_clock::now();
+    auto serial = crn::duration_cast<crn::microseconds>(t12 - t11);
+    std::cout << "std::sort on " << M << " 64-bit keys : " << serial.count() << "us\n";
 
-}
+    std::size_t maxThreads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    for (std::size_t threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        ThreadPool pool(threads);
+        auto u = keys;
+        auto t13 = crn::steady_clock::now();
+        PSampleSort(pool, u);
+        auto t14 = crn::steady_clock::now();
+        assert(u == sorted);
+        auto dt = crn::duration_cast<crn::microseconds>(t14 - t13);
+        std::cout << "Sample sort on " << M << " 64-bit keys with " << threads << " threads : " << dt.count()
+                  << "us (speedup " << static_cast<double>(serial.count()) / static_cast<double>(dt.count()) << "x)\n";
+        if (threads == maxThreads) {
+            break;
+        }
+    }
+}
\ No newline at end of file
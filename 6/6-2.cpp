@@ -1,10 +1,20 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <limits>
+#include <queue>
+#include <random>
 #include <utility>
 #include <stdexcept>
 #include <vector>
+#include <ranges>
+
+namespace sr = std::ranges;
+namespace crn = std::chrono;
+
+std::mt19937 gen(std::random_device{}());
 
 constexpr size_t D = 4;
 
@@ -75,6 +85,233 @@ void maxHeapInsert(std::pair<std::vector<T>&, size_t>& A, const T& key) {
     heapIncreaseKey(A, A.second - 1, key);
 }
 
+// d-ary heap ordered like std::priority_queue: the top is the element no other element is
+// greater than under comp. Each element gets a handle that stays valid until it leaves the heap.
+template <typename T, size_t Arity = 4, typename Comp = std::less<T>>
+class DaryHeap {
+    static_assert(Arity >= 2);
+
+public:
+    using Handle = size_t;
+
+    explicit DaryHeap(Comp comp = Comp()) : comp {comp} {}
+
+    size_t size() const {
+        return heap.size();
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    bool contains(Handle h) const {
+        return h < pos.size() && pos[h] != NONE;
+    }
+
+    const T& top() const {
+        if (heap.empty()) {
+            throw std::underflow_error("heap underflow");
+        }
+        return heap[0].key;
+    }
+
+    Handle topHandle() const {
+        if (heap.empty()) {
+            throw std::underflow_error("heap underflow");
+        }
+        return heap[0].handle;
+    }
+
+    const T& key(Handle h) const {
+        return heap[pos[h]].key;
+    }
+
+    Handle push(T key) {
+        Handle h = newHandle();
+        heap.push_back({std::move(key), h});
+        pos[h] = heap.size() - 1;
+        siftUp(heap.size() - 1);
+        return h;
+    }
+
+    // handles are assigned to the new elements in the order the range yields them
+    template <sr::input_range R>
+    std::vector<Handle> push_range(R&& keys) {
+        size_t oldSize = heap.size();
+        std::vector<Handle> handles;
+        for (auto&& key : keys) {
+            Handle h = newHandle();
+            heap.push_back({std::forward<decltype(key)>(key), h});
+            pos[h] = heap.size() - 1;
+            handles.push_back(h);
+        }
+        size_t added = heap.size() - oldSize;
+        if (added > oldSize) {
+            for (size_t i = heap.size() / Arity + 1; i-- > 0; ) {
+                siftDown(i);
+            }
+        } else {
+            for (size_t i = oldSize; i < heap.size(); i++) {
+                siftUp(i);
+            }
+        }
+        return handles;
+    }
+
+    T pop() {
+        if (heap.empty()) {
+            throw std::underflow_error("heap underflow");
+        }
+        return removeAt(0);
+    }
+
+    T erase(Handle h) {
+        return removeAt(pos[h]);
+    }
+
+    // key must not compare less than the current key
+    void increaseKey(Handle h, T key) {
+        size_t i = pos[h];
+        if (comp(key, heap[i].key)) {
+            throw std::runtime_error("new key is smaller than current key");
+        }
+        heap[i].key = std::move(key);
+        siftUp(i);
+    }
+
+    // current key must not compare less than key
+    void decreaseKey(Handle h, T key) {
+        size_t i = pos[h];
+        if (comp(heap[i].key, key)) {
+            throw std::runtime_error("new key is larger than current key");
+        }
+        heap[i].key = std::move(key);
+        siftDown(i);
+    }
+
+    void update(Handle h, T key) {
+        size_t i = pos[h];
+        bool up = comp(heap[i].key, key);
+        heap[i].key = std::move(key);
+        if (up) {
+            siftUp(i);
+        } else {
+            siftDown(i);
+        }
+    }
+
+private:
+    static constexpr size_t NONE = std::numeric_limits<size_t>::max();
+
+    struct Entry {
+        T key;
+        Handle handle;
+    };
+
+    std::vector<Entry> heap;
+    std::vector<size_t> pos;
+    std::vector<Handle> freeHandles;
+    Comp comp;
+
+    Handle newHandle() {
+        if (!freeHandles.empty()) {
+            Handle h = freeHandles.back();
+            freeHandles.pop_back();
+            return h;
+        }
+        pos.push_back(NONE);
+        return pos.size() - 1;
+    }
+
+    T removeAt(size_t i) {
+        Entry removed = std::move(heap[i]);
+        pos[removed.handle] = NONE;
+        freeHandles.push_back(removed.handle);
+        Entry last = std::move(heap.back());
+        heap.pop_back();
+        if (i < heap.size()) {
+            bool up = comp(removed.key, last.key);
+            heap[i] = std::move(last);
+            pos[heap[i].handle] = i;
+            if (up) {
+                siftUp(i);
+            } else {
+                siftDown(i);
+            }
+        }
+        return std::move(removed.key);
+    }
+
+    // the element at i is lifted out and the hole moves until the element fits
+    void siftUp(size_t i) {
+        Entry e = std::move(heap[i]);
+        while (i > 0) {
+            size_t p = (i - 1) / Arity;
+            if (!comp(heap[p].key, e.key)) {
+                break;
+            }
+            heap[i] = std::move(heap[p]);
+            pos[heap[i].handle] = i;
+            i = p;
+        }
+        heap[i] = std::move(e);
+        pos[heap[i].handle] = i;
+    }
+
+    void siftDown(size_t i) {
+        size_t n = heap.size();
+        if (i >= n) {
+            return;
+        }
+        Entry e = std::move(heap[i]);
+        while (true) {
+            size_t first = Arity * i + 1;
+            if (first >= n) {
+                break;
+            }
+            size_t last = std::min(first + Arity, n);
+            size_t best = first;
+            for (size_t c = first + 1; c < last; c++) {
+                if (comp(heap[best].key, heap[c].key)) {
+                    best = c;
+                }
+            }
+            if (!comp(e.key, heap[best].key)) {
+                break;
+            }
+            heap[i] = std::move(heap[best]);
+            pos[heap[i].handle] = i;
+            i = best;
+        }
+        heap[i] = std::move(e);
+        pos[heap[i].handle] = i;
+    }
+};
+
+template <size_t Arity>
+void benchmarkArity(const std::vector<int>& keys, const std::vector<std::pair<size_t, int>>& updates) {
+    DaryHeap<int, Arity, std::greater<int>> H;
+    auto t1 = crn::steady_clock::now();
+    auto handles = H.push_range(keys);
+    auto t2 = crn::steady_clock::now();
+    for (auto [i, delta] : updates) {
+        if (H.contains(handles[i])) {
+            H.increaseKey(handles[i], H.key(handles[i]) - delta);
+        }
+    }
+    auto t3 = crn::steady_clock::now();
+    int prev = std::numeric_limits<int>::min();
+    while (!H.empty()) {
+        int k = H.pop();
+        assert(prev <= k);
+        prev = k;
+    }
+    auto t4 = crn::steady_clock::now();
+    std::cout << "D = " << Arity << " : push_range " << crn::duration_cast<crn::microseconds>(t2 - t1).count()
+              << "us, " << updates.size() << " increase-keys " << crn::duration_cast<crn::microseconds>(t3 - t2).count()
+              << "us, pop all " << crn::duration_cast<crn::microseconds>(t4 - t3).count() << "us\n";
+}
+
 int main() {
     std::vector<int> v {1, 10, 2, 6, 9, 5, 3, 8, 7, 4};
     std::pair<std::vector<int>&, size_t> A = {v, v.size()};
@@ -82,4 +319,46 @@ int main() {
     for (auto n : v) {
         std::cout << n << ' ';
     }
+    std::cout << '\n';
+
+    DaryHeap<int, 3> H;
+    auto h = H.push(5);
+    auto handles = H.push_range(std::vector<int> {1, 10, 2, 6, 9});
+    assert(H.top() == 10);
+    H.increaseKey(h, 20);
+    assert(H.topHandle() == h);
+    H.decreaseKey(h, 0);
+    assert(H.top() == 10);
+    H.erase(handles[1]);
+    H.update(handles[0], 7);
+    std::vector<int> order;
+    while (!H.empty()) {
+        order.push_back(H.pop());
+    }
+    assert((order == std::vector<int> {9, 7, 6, 2, 0}));
+
+    constexpr size_t N = 1'000'000;
+    std::vector<int> keys (N);
+    std::uniform_int_distribution<> dist(0, 1'000'000'000);
+    for (auto& k : keys) {
+        k = dist(gen);
+    }
+    std::vector<std::pair<size_t, int>> updates (N);
+    std::uniform_int_distribution<size_t> idx(0, N - 1);
+    std::uniform_int_distribution<> delta(0, 1'000);
+    for (auto& u : updates) {
+        u = {idx(gen), delta(gen)};
+    }
+
+    auto t1 = crn::steady_clock::now();
+    std::priority_queue<int, std::vector<int>, std::greater<int>> Q (std::greater<int> {}, keys);
+    while (!Q.empty()) {
+        Q.pop();
+    }
+    auto t2 = crn::steady_clock::now();
+    std::cout << "std::priority_queue : build and pop all " << crn::duration_cast<crn::microseconds>(t2 - t1).count() << "us\n";
+    benchmarkArity<2>(keys, updates);
+    benchmarkArity<4>(keys, updates);
+    benchmarkArity<8>(keys, updates);
+    benchmarkArity<16>(keys, updates);
 }
\ No newline at end of file
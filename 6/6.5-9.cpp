@@ -1,16 +1,24 @@
+#include <algorithm>
+#include <bit>
 #include <cassert>
 #include <chrono>
 #include <cstdlib>
+#include <filesystem>
 #include <forward_list>
+#include <fstream>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
 #include <queue>
 #include <random>
+#include <span>
+#include <string>
 #include <utility>
 #include <vector>
 
 namespace crn = std::chrono;
+namespace fs = std::filesystem;
 
 using it_p_t = std::pair<std::forward_list<int>::const_iterator,
         std::forward_list<int>::const_iterator>;
@@ -45,6 +53,134 @@ std::forward_list<int> mergeKLists(const std::vector<std::forward_list<int>>& li
     return merged_list;
 }
 
+// tournament tree over k sorted sources: each internal node keeps the loser of the match
+// played there (with a copy of its current key) and node 0 keeps the overall winner, so
+// advancing the winner replays only its own leaf-to-root path with one comparison per level.
+// An exhausted source loses every match, so no sentinel key is needed. Equal keys are taken
+// from the lower source first.
+template <typename T, typename Comp = std::less<T>>
+class LoserTree {
+public:
+    // called when a source runs dry; returns the next block of that source, empty at the end
+    using Refill = std::function<std::span<const T>(size_t)>;
+
+    explicit LoserTree(const std::vector<std::span<const T>>& runs, Refill refill = {}, Comp comp = Comp())
+        : k {std::bit_ceil(std::max<size_t>(runs.size(), 2))}, cur (k), end (k), tree (k),
+          refill {std::move(refill)}, comp {comp} {
+        for (size_t i = 0; i < runs.size(); i++) {
+            cur[i] = runs[i].data();
+            end[i] = runs[i].data() + runs[i].size();
+        }
+        std::vector<Node> winner (2 * k);
+        for (size_t i = 0; i < k; i++) {
+            winner[k + i] = leaf(i);
+        }
+        for (size_t node = k - 1; node > 0; node--) {
+            const Node& a = winner[2 * node];
+            const Node& b = winner[2 * node + 1];
+            if (beats(a, b)) {
+                winner[node] = a;
+                tree[node] = b;
+            } else {
+                winner[node] = b;
+                tree[node] = a;
+            }
+        }
+        tree[0] = winner[1];
+    }
+
+    LoserTree(size_t sources, Refill refill, Comp comp = Comp())
+        : LoserTree(firstBlocks(sources, refill), refill, comp) {}
+
+    bool empty() const {
+        return tree[0].done;
+    }
+
+    // writes merged elements until out is full or every source is exhausted; returns the count
+    size_t merge(std::span<T> out) {
+        size_t n = 0;
+        while (n < out.size() && !tree[0].done) {
+            size_t s = tree[0].source;
+            out[n++] = std::move(tree[0].key);
+            if (++cur[s] == end[s] && refill) {
+                auto next = refill(s);
+                cur[s] = next.data();
+                end[s] = next.data() + next.size();
+            }
+            Node w = leaf(s);
+            for (size_t node = (s + k) / 2; node > 0; node /= 2) {
+                if (beats(tree[node], w)) {
+                    std::swap(tree[node], w);
+                }
+            }
+            tree[0] = std::move(w);
+        }
+        return n;
+    }
+
+private:
+    struct Node {
+        T key {};
+        size_t source = 0;
+        bool done = true;
+    };
+
+    size_t k;
+    std::vector<const T*> cur;
+    std::vector<const T*> end;
+    std::vector<Node> tree;
+    Refill refill;
+    Comp comp;
+
+    static std::vector<std::span<const T>> firstBlocks(size_t sources, const Refill& refill) {
+        std::vector<std::span<const T>> blocks;
+        for (size_t i = 0; i < sources; i++) {
+            blocks.push_back(refill(i));
+        }
+        return blocks;
+    }
+
+    Node leaf(size_t s) const {
+        if (cur[s] == end[s]) {
+            return {T {}, s, true};
+        }
+        return {*cur[s], s, false};
+    }
+
+    bool beats(const Node& a, const Node& b) const {
+        if (a.done || b.done) {
+            return !a.done;
+        }
+        if (comp(a.key, b.key)) {
+            return true;
+        }
+        return !comp(b.key, a.key) && a.source < b.source;
+    }
+};
+
+template <typename T>
+void mergeKRanges(const std::vector<std::span<const T>>& runs, std::span<T> out) {
+    LoserTree<T> tree(runs);
+    tree.merge(out);
+    assert(tree.empty());
+}
+
+// reads a file of raw T values one block at a time
+template <typename T>
+class RunReader {
+public:
+    RunReader(const fs::path& path, size_t blockSize) : in (path, std::ios::binary), buffer (blockSize) {}
+
+    std::span<const T> next() {
+        in.read(reinterpret_cast<char*>(buffer.data()), static_cast<std::streamsize>(buffer.size() * sizeof(T)));
+        return {buffer.data(), static_cast<size_t>(in.gcount()) / sizeof(T)};
+    }
+
+private:
+    std::ifstream in;
+    std::vector<T> buffer;
+};
+
 int main() {
     std::forward_list<int> A {1, 4, 5};
     std::forward_list<int> B {1, 3, 4};
@@ -54,6 +190,11 @@ int main() {
     auto ABC = mergeKLists(v);
     assert(ABC == ABC_correct);
 
+    std::vector<int> a {1, 4, 5}, b {1, 3, 4}, c {}, d {2, 6};
+    std::vector<int> abcd (8);
+    mergeKRanges<int>({a, b, c, d}, abcd);
+    assert((abcd == std::vector<int> {1, 1, 2, 3, 4, 4, 5, 6}));
+
     constexpr size_t MAX_SIZE = 1'000'000;
     constexpr size_t NUM_LISTS = 10;
     std::vector<std::forward_list<int>> v2 (NUM_LISTS);
@@ -71,5 +212,62 @@ int main() {
     assert(diff.count() < 1000);
     std::cout << "OK\n";
 
+    constexpr size_t K = 512;
+    constexpr size_t TOTAL = 4'000'000;
+    std::vector<std::vector<int>> runs (K);
+    std::uniform_int_distribution<> runDist(0, K - 1);
+    for (size_t i = 0; i < TOTAL; i++) {
+        runs[runDist(gen)].push_back(static_cast<int>(i));
+    }
+    std::vector<int> expected (TOTAL);
+    std::iota(expected.begin(), expected.end(), 0);
+
+    std::vector<std::forward_list<int>> lists;
+    for (const auto& run : runs) {
+        lists.emplace_back(run.begin(), run.end());
+    }
+    auto t1 = crn::steady_clock::now();
+    auto merged_list = mergeKLists(lists);
+    auto t2 = crn::steady_clock::now();
+    std::cout << "priority_queue merge of " << K << " lists (" << TOTAL << " elements) : "
+              << crn::duration_cast<crn::microseconds>(t2 - t1).count() << "us\n";
+
+    std::vector<std::span<const int>> spans (runs.begin(), runs.end());
+    std::vector<int> out (TOTAL);
+    auto t3 = crn::steady_clock::now();
+    mergeKRanges<int>(spans, out);
+    auto t4 = crn::steady_clock::now();
+    assert(out == expected);
+    std::cout << "Loser tree merge of " << K << " ranges (" << TOTAL << " elements) : "
+              << crn::duration_cast<crn::microseconds>(t4 - t3).count() << "us\n";
+
+    constexpr size_t BLOCK = 4'096;
+    auto dir = fs::temp_directory_path() / ("loser_tree_runs_" + std::to_string(gen()));
+    fs::create_directories(dir);
+    for (size_t i = 0; i < K; i++) {
+        std::ofstream f (dir / std::to_string(i), std::ios::binary);
+        f.write(reinterpret_cast<const char*>(runs[i].data()), static_cast<std::streamsize>(runs[i].size() * sizeof(int)));
+    }
+    auto t5 = crn::steady_clock::now();
+    {
+        std::vector<RunReader<int>> readers;
+        readers.reserve(K);
+        for (size_t i = 0; i < K; i++) {
+            readers.emplace_back(dir / std::to_string(i), BLOCK);
+        }
+        LoserTree<int> tree(K, [&readers](size_t i) { return readers[i].next(); });
+        std::vector<int> block (BLOCK);
+        size_t pos = 0;
+        while (size_t n = tree.merge(block)) {
+            assert(std::equal(block.begin(), block.begin() + n, expected.begin() + pos));
+            pos += n;
+        }
+        assert(pos == TOTAL);
+    }
+    auto t6 = crn::steady_clock::now();
+    fs::remove_all(dir);
+    std::cout << "Streaming loser tree merge of " << K << " files (" << TOTAL << " elements) : "
+              << crn::duration_cast<crn::microseconds>(t6 - t5).count() << "us\n";
+
     return EXIT_SUCCESS;
 }
\ No newline at end of file
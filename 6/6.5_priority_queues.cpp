@@ -1,16 +1,23 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <iostream>
 #include <limits>
+#include <queue>
+#include <random>
 #include <utility>
 #include <stdexcept>
 #include <vector>
 #include <ranges>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
+
+std::mt19937 gen(std::random_device{}());
 
 size_t parent(size_t i) {
-    return i / 2;
+    if (i == 0) return 0;
+    return (i - 1) / 2;
 }
 
 size_t left(size_t i) {
@@ -21,21 +28,38 @@ size_t right(size_t i) {
     return 2 * i + 2;
 }
 
+// the key at i is lifted out and the hole moves down until the key fits
 template <typename T>
 void maxHeapify(std::pair<std::vector<T>&, size_t>& A, size_t i) {
-    auto l = left(i);
-    auto r = right(i);
-    size_t largest = i;
-    if (l < A.second && A.first[l] > A.first[i]) {
-        largest = l;
+    auto& H = A.first;
+    size_t n = A.second;
+    if (i >= n) {
+        return;
     }
-    if (r < A.second && A.first[r] > A.first[largest]) {
-        largest = r;
+    T key = std::move(H[i]);
+    while (left(i) < n) {
+        size_t largest = left(i);
+        if (right(i) < n && H[largest] < H[right(i)]) {
+            largest = right(i);
+        }
+        if (!(key < H[largest])) {
+            break;
+        }
+        H[i] = std::move(H[largest]);
+        i = largest;
     }
-    if (largest != i) {
-        std::swap(A.first[i], A.first[largest]);
-        maxHeapify(A, largest);
+    H[i] = std::move(key);
+}
+
+// places key in the hole at i and moves the hole up until the key fits
+template <typename T>
+void siftUp(std::pair<std::vector<T>&, size_t>& A, size_t i, T key) {
+    auto& H = A.first;
+    while (i > 0 && H[parent(i)] < key) {
+        H[i] = std::move(H[parent(i)]);
+        i = parent(i);
     }
+    H[i] = std::move(key);
 }
 
 template <typename T>
@@ -58,8 +82,8 @@ void heapSort(std::vector<T>& v) {
 }
 
 template <typename T>
-T heapMaximum(const std::pair<std::vector<T>&, size_t>& v) {
-    return v[0];
+T heapMaximum(const std::pair<std::vector<T>&, size_t>& A) {
+    return A.first[0];
 }
 
 template <typename T>
@@ -67,8 +91,8 @@ T heapExtractMax(std::pair<std::vector<T>&, size_t>& A) {
     if (A.second < 1) {
         throw std::underflow_error("heap underflow");
     }
-    T maxElem = A.first[0];
-    A.first[0] = A.first[A.second - 1];
+    T maxElem = std::move(A.first[0]);
+    A.first[0] = std::move(A.first[A.second - 1]);
     A.second--;
     maxHeapify(A, 0);
     return maxElem;
@@ -79,18 +103,75 @@ void heapIncreaseKey(std::pair<std::vector<T>&, size_t>& A, size_t i, const T& k
     if (key < A.first[i]) {
         throw std::runtime_error("new key is smaller than current key");
     }
-    A.first[i] = key;
-    while (i > 0 && A.first[parent(i)] < A.first[i]) {
-        std::swap(A.first[i], A.first[parent(i)]);
-        i = parent(i);
-    }
+    siftUp(A, i, key);
 }
 
 template <typename T>
 void maxHeapInsert(std::pair<std::vector<T>&, size_t>& A, const T& key) {
+    A.first.resize(A.second);
+    A.first.push_back(key);
     A.second++;
-    A.first.push_back(std::numeric_limits<T>::min());
-    heapIncreaseKey(A, A.second - 1, key);
+    siftUp(A, A.second - 1, key);
+}
+
+// appends all keys, then restores the heap bottom-up over the ancestors of the new leaves only,
+// visiting each of them once in decreasing index order: O(m + log^2 n) for m keys
+template <typename T>
+void maxHeapInsertBatch(std::pair<std::vector<T>&, size_t>& A, const std::vector<T>& keys) {
+    size_t n = A.second;
+    size_t m = keys.size();
+    if (m == 0) {
+        return;
+    }
+    A.first.resize(n);
+    A.first.insert(A.first.end(), keys.begin(), keys.end());
+    if (m >= n) {
+        buildMaxHeap(A);
+        return;
+    }
+    A.second = n + m;
+    size_t lo = n;
+    size_t hi = n + m - 1;
+    while (lo > 0) {
+        size_t parentLo = parent(lo);
+        size_t parentHi = std::min(parent(hi), lo - 1);
+        for (size_t i = parentHi + 1; i-- > parentLo; ) {
+            maxHeapify(A, i);
+        }
+        lo = parentLo;
+        hi = parentHi;
+    }
+}
+
+// removes the k largest keys in decreasing order; each removal walks the hole from the root
+// to a leaf with one comparison per level and then lets the last key climb back up from there,
+// which is usually only a level or two
+template <typename T>
+std::vector<T> heapExtractTopK(std::pair<std::vector<T>&, size_t>& A, size_t k) {
+    auto& H = A.first;
+    k = std::min(k, A.second);
+    std::vector<T> top;
+    top.reserve(k);
+    for (size_t j = 0; j < k; j++) {
+        top.push_back(std::move(H[0]));
+        size_t n = --A.second;
+        if (n == 0) {
+            break;
+        }
+        T last = std::move(H[n]);
+        size_t i = 0;
+        while (right(i) < n) {
+            size_t c = left(i) + (H[left(i)] < H[right(i)]);
+            H[i] = std::move(H[c]);
+            i = c;
+        }
+        if (left(i) < n) {
+            H[i] = std::move(H[left(i)]);
+            i = left(i);
+        }
+        siftUp(A, i, std::move(last));
+    }
+    return top;
 }
 
 int main() {
@@ -99,4 +180,82 @@ int main() {
     std::pair<std::vector<int>&, size_t> A = {v, v.size()};
     maxHeapInsert(A, 6);
     assert(sr::is_heap(v));
+    maxHeapInsertBatch(A, {2, 7, 1, 8});
+    assert(sr::is_heap(v) && heapMaximum(A) == 9);
+    assert((heapExtractTopK(A, 3) == std::vector<int> {9, 8, 7}));
+    assert(sr::is_heap(v.begin(), v.begin() + A.second));
+
+    std::uniform_int_distribution<> dist;
+    for (size_t n = 0; n < 200; n += 7) {
+        for (size_t m = 0; m < 300; m += 11) {
+            std::vector<int> w (n);
+            for (auto& x : w) {
+                x = dist(gen);
+            }
+            sr::make_heap(w);
+            std::pair<std::vector<int>&, size_t> B = {w, w.size()};
+            std::vector<int> keys (m);
+            for (auto& x : keys) {
+                x = dist(gen);
+            }
+            maxHeapInsertBatch(B, keys);
+            assert(B.second == n + m && sr::is_heap(w));
+            auto expected = w;
+            sr::sort(expected, std::greater<>());
+            auto top = heapExtractTopK(B, m / 2 + 1);
+            assert(sr::equal(top, expected | std::views::take(top.size())));
+            assert(sr::is_heap(w.begin(), w.begin() + B.second));
+        }
+    }
+
+    constexpr size_t OPS = 1'000'000;
+    constexpr size_t BATCH = 1'024;
+    std::vector<int> keys (OPS);
+    for (auto& x : keys) {
+        x = dist(gen);
+    }
+
+    auto t1 = crn::steady_clock::now();
+    std::priority_queue<int> Q;
+    for (auto x : keys) {
+        Q.push(x);
+    }
+    while (!Q.empty()) {
+        Q.pop();
+    }
+    auto t2 = crn::steady_clock::now();
+    std::cout << "std::priority_queue, " << OPS << " pushes and pops : "
+              << crn::duration_cast<crn::microseconds>(t2 - t1).count() << "us\n";
+
+    std::vector<int> h1;
+    std::pair<std::vector<int>&, size_t> H1 = {h1, 0};
+    auto t3 = crn::steady_clock::now();
+    for (auto x : keys) {
+        maxHeapInsert(H1, x);
+    }
+    while (H1.second > 0) {
+        heapExtractMax(H1);
+    }
+    auto t4 = crn::steady_clock::now();
+    std::cout << "Single-key insert and extract, " << OPS << " ops each : "
+              << crn::duration_cast<crn::microseconds>(t4 - t3).count() << "us\n";
+
+    std::vector<int> h2;
+    std::pair<std::vector<int>&, size_t> H2 = {h2, 0};
+    std::vector<int> batch;
+    auto t5 = crn::steady_clock::now();
+    for (size_t i = 0; i < OPS; i += BATCH) {
+        batch.assign(keys.begin() + i, keys.begin() + std::min(i + BATCH, OPS));
+        maxHeapInsertBatch(H2, batch);
+    }
+    int prev = std::numeric_limits<int>::max();
+    while (H2.second > 0) {
+        for (auto x : heapExtractTopK(H2, BATCH)) {
+            assert(x <= prev);
+            prev = x;
+        }
+    }
+    auto t6 = crn::steady_clock::now();
+    std::cout << "Batched insert and top-k extract (batches of " << BATCH << "), " << OPS << " ops each : "
+              << crn::duration_cast<crn::microseconds>(t6 - t5).count() << "us\n";
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <bit>
+#include <functional>
 #include <iostream>
 #include <random>
 #include <numeric>
+#include <utility>
 #include <vector>
 #include <ranges>
 
@@ -35,11 +38,12 @@ size_t medianThreePartition(std::vector<T>& A, size_t p, size_t r) {
     temp.push_back(dist(gen));
     std::sort(temp.begin(), temp.end());
     size_t idx = temp[1];
+    std::swap(A[idx], A[r]);
 
-    T x = A[idx];
+    T x = A[r];
     size_t i = p;
     for (size_t j = p; j < r; j++) {
-        if (A[j] >= x) {
+        if (A[j] <= x) {
             std::swap(A[i], A[j]);
             i++;
         }
@@ -66,40 +70,307 @@ void quickSort(std::vector<T>& A, size_t p, size_t r) {
     }
 }
 
+template <typename T>
+void tailRecursiveQuickSort(std::vector<T>& A, size_t p, size_t r) {
+    while (p < r && r < A.size()) {
+        size_t q = partition(A, p, r);
+        size_t m = (p + r) / 2;
+        if (q < m) {
+            tailRecursiveQuickSort(A, p, q - 1);
+            p = q + 1;
+        } else {
+            tailRecursiveQuickSort(A, q + 1, r);
+            r = q - 1;
+        }
+    }
+}
+
+constexpr ptrdiff_t INSERTION_SORT_THRESHOLD = 24;
+constexpr ptrdiff_t NINTHER_THRESHOLD = 128;
+constexpr ptrdiff_t PARTIAL_INSERTION_SORT_LIMIT = 8;
+
+template <typename Iter, typename Compare>
+void insertionSort(Iter first, Iter last, Compare comp) {
+    if (first == last) {
+        return;
+    }
+    for (Iter cur = first + 1; cur != last; ++cur) {
+        Iter sift = cur;
+        Iter sift1 = cur - 1;
+        if (comp(*sift, *sift1)) {
+            auto key = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (sift != first && comp(key, *--sift1));
+            *sift = std::move(key);
+        }
+    }
+}
+
+// requires an element before first that is not greater than anything in [first, last)
+template <typename Iter, typename Compare>
+void unguardedInsertionSort(Iter first, Iter last, Compare comp) {
+    if (first == last) {
+        return;
+    }
+    for (Iter cur = first + 1; cur != last; ++cur) {
+        Iter sift = cur;
+        Iter sift1 = cur - 1;
+        if (comp(*sift, *sift1)) {
+            auto key = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (comp(key, *--sift1));
+            *sift = std::move(key);
+        }
+    }
+}
+
+// gives up and returns false once more than PARTIAL_INSERTION_SORT_LIMIT elements have been moved
+template <typename Iter, typename Compare>
+bool partialInsertionSort(Iter first, Iter last, Compare comp) {
+    if (first == last) {
+        return true;
+    }
+    ptrdiff_t moved = 0;
+    for (Iter cur = first + 1; cur != last; ++cur) {
+        Iter sift = cur;
+        Iter sift1 = cur - 1;
+        if (comp(*sift, *sift1)) {
+            auto key = std::move(*sift);
+            do {
+                *sift-- = std::move(*sift1);
+            } while (sift != first && comp(key, *--sift1));
+            *sift = std::move(key);
+            moved += cur - sift;
+        }
+        if (moved > PARTIAL_INSERTION_SORT_LIMIT) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Iter, typename Compare>
+void sort2(Iter a, Iter b, Compare comp) {
+    if (comp(*b, *a)) {
+        std::iter_swap(a, b);
+    }
+}
+
+template <typename Iter, typename Compare>
+void sort3(Iter a, Iter b, Iter c, Compare comp) {
+    sort2(a, b, comp);
+    sort2(b, c, comp);
+    sort2(a, b, comp);
+}
+
+// partitions around *first, placing elements equal to the pivot on the right
+template <typename Iter, typename Compare>
+std::pair<Iter, bool> partitionRight(Iter first, Iter last, Compare comp) {
+    auto pivot = std::move(*first);
+    Iter i = first;
+    Iter j = last;
+    while (comp(*++i, pivot));
+    if (i - 1 == first) {
+        while (i < j && !comp(*--j, pivot));
+    } else {
+        while (!comp(*--j, pivot));
+    }
+    bool alreadyPartitioned = i >= j;
+    while (i < j) {
+        std::iter_swap(i, j);
+        while (comp(*++i, pivot));
+        while (!comp(*--j, pivot));
+    }
+    Iter pivotPos = i - 1;
+    *first = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return {pivotPos, alreadyPartitioned};
+}
+
+// partitions around *first, placing elements equal to the pivot on the left
+template <typename Iter, typename Compare>
+Iter partitionLeft(Iter first, Iter last, Compare comp) {
+    auto pivot = std::move(*first);
+    Iter i = first;
+    Iter j = last;
+    while (comp(pivot, *--j));
+    if (j + 1 == last) {
+        while (i < j && !comp(pivot, *++i));
+    } else {
+        while (!comp(pivot, *++i));
+    }
+    while (i < j) {
+        std::iter_swap(i, j);
+        while (comp(pivot, *--j));
+        while (!comp(pivot, *++i));
+    }
+    Iter pivotPos = j;
+    *first = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return pivotPos;
+}
+
+// swaps a few elements at fixed offsets to break up patterns that caused a bad partition
+template <typename Iter>
+void breakPatterns(Iter first, Iter last) {
+    ptrdiff_t size = last - first;
+    if (size < INSERTION_SORT_THRESHOLD) {
+        return;
+    }
+    std::iter_swap(first, first + size / 4);
+    std::iter_swap(last - 1, last - size / 4);
+    if (size > NINTHER_THRESHOLD) {
+        std::iter_swap(first + 1, first + (size / 4 + 1));
+        std::iter_swap(first + 2, first + (size / 4 + 2));
+        std::iter_swap(last - 2, last - (size / 4 + 1));
+        std::iter_swap(last - 3, last - (size / 4 + 2));
+    }
+}
+
+template <typename Iter, typename Compare>
+void introSortLoop(Iter first, Iter last, Compare comp, int badAllowed, bool leftmost) {
+    while (true) {
+        ptrdiff_t size = last - first;
+        if (size < INSERTION_SORT_THRESHOLD) {
+            if (leftmost) {
+                insertionSort(first, last, comp);
+            } else {
+                unguardedInsertionSort(first, last, comp);
+            }
+            return;
+        }
+
+        ptrdiff_t half = size / 2;
+        if (size > NINTHER_THRESHOLD) {
+            sort3(first, first + half, last - 1, comp);
+            sort3(first + 1, first + (half - 1), last - 2, comp);
+            sort3(first + 2, first + (half + 1), last - 3, comp);
+            sort3(first + (half - 1), first + half, first + (half + 1), comp);
+            std::iter_swap(first, first + half);
+        } else {
+            sort3(first + half, first, last - 1, comp);
+        }
+
+        // the pivot equals the element left of this range, so nothing here is smaller than it
+        if (!leftmost && !comp(*(first - 1), *first)) {
+            first = partitionLeft(first, last, comp) + 1;
+            continue;
+        }
+
+        auto [pivotPos, alreadyPartitioned] = partitionRight(first, last, comp);
+        ptrdiff_t leftSize = pivotPos - first;
+        ptrdiff_t rightSize = last - (pivotPos + 1);
+        if (leftSize < size / 8 || rightSize < size / 8) {
+            if (--badAllowed == 0) {
+                std::make_heap(first, last, comp);
+                std::sort_heap(first, last, comp);
+                return;
+            }
+            breakPatterns(first, pivotPos);
+            breakPatterns(pivotPos + 1, last);
+        } else if (alreadyPartitioned && partialInsertionSort(first, pivotPos, comp) &&
+                   partialInsertionSort(pivotPos + 1, last, comp)) {
+            return;
+        }
+
+        introSortLoop(first, pivotPos, comp, badAllowed, leftmost);
+        first = pivotPos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename Iter, typename Compare = std::less<>>
+void sort(Iter first, Iter last, Compare comp = Compare()) {
+    if (last - first < 2) {
+        return;
+    }
+    introSortLoop(first, last, comp, std::bit_width(static_cast<size_t>(last - first)), true);
+}
+
 int main() {
+    std::vector<int> w {3, 2, 6, 1, 5, 4};
+    ::sort(w.begin(), w.end());
+    assert(sr::is_sorted(w));
+    ::sort(w.begin(), w.end(), std::greater<>());
+    assert(sr::is_sorted(w, std::greater<>()));
+    for (size_t n = 0; n < 2'000; n += 13) {
+        std::vector<int> u (n);
+        std::uniform_int_distribution<> dist(0, static_cast<int>(n % 7 == 0 ? 3 : n));
+        for (auto& x : u) {
+            x = dist(gen);
+        }
+        ::sort(u.begin(), u.end());
+        assert(sr::is_sorted(u));
+    }
+
     constexpr size_t N = 10'000;
-    std::vector<int> v (N);
-    std::iota(v.begin(), v.end(), 0);
-
-    constexpr size_t TRIALS = 1'000;
-
-    crn::microseconds DT(0), DT2(0), DT3(0);
-    for (size_t t = 0; t < TRIALS; t++) {
-        auto u = v;
-        sr::shuffle(u, gen);
-        auto t1 = crn::steady_clock::now();
-        medianThreeQuickSort(u, 0, u.size() - 1);
-        auto t2 = crn::steady_clock::now();
-        auto dt = crn::duration_cast<crn::microseconds>(t2 - t1);
-        DT += dt;
-
-        sr::shuffle(u, gen);
-        auto t3 = crn::steady_clock::now();
-        quickSort(u, 0, u.size() - 1);
-        auto t4 = crn::steady_clock::now();
-        auto dt2 = crn::duration_cast<crn::microseconds>(t4 - t3);
-        DT2 += dt2;
-
-        sr::shuffle(u, gen);
-        auto t5 = crn::steady_clock::now();
-        sr::sort(u);
-        auto t6 = crn::steady_clock::now();
-        auto dt3 = crn::duration_cast<crn::microseconds>(t6 - t5);
-
-        DT3 += dt3;
-    }
-    std::cout << "Average performance of median-of-3 quicksort on " << N << " elements : " << DT.count() / TRIALS << "ms\n";
-    std::cout << "Average performance of quicksort on " << N << " elements : " << DT2.count() / TRIALS << "ms\n";
-    std::cout << "Average performance of std::sort on " << N << " elements : " << DT3.count() / TRIALS << "ms\n";
+    std::vector<int> random (N);
+    std::iota(random.begin(), random.end(), 0);
+    sr::shuffle(random, gen);
+    std::vector<int> sorted (N);
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::vector<int> reversed (sorted.rbegin(), sorted.rend());
+    std::vector<int> organPipe (N);
+    for (size_t i = 0; i < N; i++) {
+        organPipe[i] = static_cast<int>(i < N / 2 ? i : N - i);
+    }
+    std::vector<int> duplicates (N);
+    std::uniform_int_distribution<> dist(0, 15);
+    for (auto& n : duplicates) {
+        n = dist(gen);
+    }
+
+    constexpr size_t TRIALS = 10;
+
+    std::pair<const char*, const std::vector<int>*> inputs[] = {
+        {"random", &random}, {"sorted", &sorted}, {"reversed", &reversed},
+        {"organ-pipe", &organPipe}, {"many-duplicates", &duplicates}
+    };
+    for (auto [name, input] : inputs) {
+        crn::microseconds DT(0), DT2(0), DT3(0), DT4(0), DT5(0);
+        for (size_t t = 0; t < TRIALS; t++) {
+            auto u = *input;
+            auto t1 = crn::steady_clock::now();
+            ::sort(u.begin(), u.end());
+            auto t2 = crn::steady_clock::now();
+            DT += crn::duration_cast<crn::microseconds>(t2 - t1);
+            assert(sr::is_sorted(u));
+
+            u = *input;
+            auto t3 = crn::steady_clock::now();
+            medianThreeQuickSort(u, 0, u.size() - 1);
+            auto t4 = crn::steady_clock::now();
+            DT2 += crn::duration_cast<crn::microseconds>(t4 - t3);
+            assert(sr::is_sorted(u));
+
+            u = *input;
+            auto t5 = crn::steady_clock::now();
+            quickSort(u, 0, u.size() - 1);
+            auto t6 = crn::steady_clock::now();
+            DT3 += crn::duration_cast<crn::microseconds>(t6 - t5);
+            assert(sr::is_sorted(u));
+
+            u = *input;
+            auto t7 = crn::steady_clock::now();
+            tailRecursiveQuickSort(u, 0, u.size() - 1);
+            auto t8 = crn::steady_clock::now();
+            DT4 += crn::duration_cast<crn::microseconds>(t8 - t7);
+            assert(sr::is_sorted(u));
+
+            u = *input;
+            auto t9 = crn::steady_clock::now();
+            sr::sort(u);
+            auto t10 = crn::steady_clock::now();
+            DT5 += crn::duration_cast<crn::microseconds>(t10 - t9);
+        }
+        std::cout << "Average performance on " << N << " " << name << " elements\n";
+        std::cout << "  introsort : " << DT.count() / TRIALS << "us\n";
+        std::cout << "  median-of-3 quicksort : " << DT2.count() / TRIALS << "us\n";
+        std::cout << "  quicksort : " << DT3.count() / TRIALS << "us\n";
+        std::cout << "  tail-recursive quicksort : " << DT4.count() / TRIALS << "us\n";
+        std::cout << "  std::sort : " << DT5.count() / TRIALS << "us\n";
+    }
 
 }
\ No newline at end of file
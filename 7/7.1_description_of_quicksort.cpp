@@ -1,9 +1,17 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <compare>
+#include <cstdint>
+#include <iostream>
+#include <random>
 #include <vector>
 #include <ranges>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
+
+std::mt19937 gen(std::random_device{}());
 
 template <typename T>
 size_t partition(std::vector<T>& A, size_t p, size_t r) {
@@ -19,17 +27,162 @@ size_t partition(std::vector<T>& A, size_t p, size_t r) {
     return i;
 }
 
+constexpr size_t PARTITION_BLOCK = 128;
+
+// same contract as partition, but classifies elements a block at a time into offset buffers
+// so the comparisons feed arithmetic instead of branches
 template <typename T>
+size_t blockPartition(std::vector<T>& A, size_t p, size_t r) {
+    const T x = A[r];
+    unsigned char offsetsL[PARTITION_BLOCK];
+    unsigned char offsetsR[PARTITION_BLOCK];
+    size_t first = p;
+    size_t last = r;
+    size_t numL = 0;
+    size_t numR = 0;
+    size_t startL = 0;
+    size_t startR = 0;
+    while (last - first > 2 * PARTITION_BLOCK) {
+        if (numL == 0) {
+            startL = 0;
+            for (size_t i = 0; i < PARTITION_BLOCK; i++) {
+                offsetsL[numL] = static_cast<unsigned char>(i);
+                numL += x < A[first + i];
+            }
+        }
+        if (numR == 0) {
+            startR = 0;
+            for (size_t i = 0; i < PARTITION_BLOCK; i++) {
+                offsetsR[numR] = static_cast<unsigned char>(i);
+                numR += !(x < A[last - 1 - i]);
+            }
+        }
+        size_t num = std::min(numL, numR);
+        for (size_t k = 0; k < num; k++) {
+            std::swap(A[first + offsetsL[startL + k]], A[last - 1 - offsetsR[startR + k]]);
+        }
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0) {
+            first += PARTITION_BLOCK;
+        }
+        if (numR == 0) {
+            last -= PARTITION_BLOCK;
+        }
+    }
+
+    size_t i = first;
+    size_t j = last;
+    while (true) {
+        while (i < j && !(x < A[i])) {
+            i++;
+        }
+        while (i < j && x < A[j - 1]) {
+            j--;
+        }
+        if (i >= j) {
+            break;
+        }
+        std::swap(A[i], A[j - 1]);
+        i++;
+        j--;
+    }
+    std::swap(A[i], A[r]);
+    return i;
+}
+
+struct LomutoPartition {
+    template <typename T>
+    size_t operator()(std::vector<T>& A, size_t p, size_t r) const {
+        return partition(A, p, r);
+    }
+};
+
+struct BlockPartition {
+    template <typename T>
+    size_t operator()(std::vector<T>& A, size_t p, size_t r) const {
+        return blockPartition(A, p, r);
+    }
+};
+
+template <typename Partition = LomutoPartition, typename T>
 void quickSort(std::vector<T>& A, size_t p, size_t r) {
     if (p < r && r < A.size()) {
-        size_t q = partition(A, p, r);
-        quickSort(A, p, q - 1);
-        quickSort(A, q + 1, r);
+        size_t q = Partition{}(A, p, r);
+        quickSort<Partition>(A, p, q - 1);
+        quickSort<Partition>(A, q + 1, r);
+    }
+}
+
+struct Record {
+    std::int64_t key;
+    std::int64_t payload;
+    auto operator<=>(const Record&) const = default;
+};
+
+template <typename T, typename Dist>
+void benchmark(const char* name, Dist dist) {
+    constexpr size_t N = 1'000'000;
+    constexpr size_t TRIALS = 10;
+    std::vector<T> v (N);
+    crn::microseconds partitionDT[2] {}, sortDT[2] {};
+    for (size_t t = 0; t < TRIALS; t++) {
+        for (auto& x : v) {
+            x = dist();
+        }
+        auto u = v;
+        auto w = v;
+        auto t1 = crn::steady_clock::now();
+        size_t q1 = LomutoPartition{}(u, 0, N - 1);
+        auto t2 = crn::steady_clock::now();
+        size_t q2 = BlockPartition{}(w, 0, N - 1);
+        auto t3 = crn::steady_clock::now();
+        assert(q1 == q2);
+        partitionDT[0] += crn::duration_cast<crn::microseconds>(t2 - t1);
+        partitionDT[1] += crn::duration_cast<crn::microseconds>(t3 - t2);
+
+        u = v;
+        auto t4 = crn::steady_clock::now();
+        quickSort<LomutoPartition>(u, 0, N - 1);
+        auto t5 = crn::steady_clock::now();
+        w = v;
+        auto t6 = crn::steady_clock::now();
+        quickSort<BlockPartition>(w, 0, N - 1);
+        auto t7 = crn::steady_clock::now();
+        assert(sr::is_sorted(u) && u == w);
+        sortDT[0] += crn::duration_cast<crn::microseconds>(t5 - t4);
+        sortDT[1] += crn::duration_cast<crn::microseconds>(t7 - t6);
     }
+    std::cout << name << " (" << N << " random elements)\n";
+    std::cout << "  Lomuto partition pass : " << partitionDT[0].count() / TRIALS << "us\n";
+    std::cout << "  block partition pass : " << partitionDT[1].count() / TRIALS << "us\n";
+    std::cout << "  quicksort with Lomuto partition : " << sortDT[0].count() / TRIALS << "us\n";
+    std::cout << "  quicksort with block partition : " << sortDT[1].count() / TRIALS << "us\n";
 }
 
 int main() {
     std::vector<int> v {3, 2, 6, 1, 5, 4};
     quickSort(v, 0, v.size() - 1);
     assert(sr::is_sorted(v));
+
+    for (size_t n = 1; n < 3'000; n += 17) {
+        std::vector<int> u (n);
+        std::uniform_int_distribution<> dist(0, static_cast<int>(n / 2));
+        for (auto& x : u) {
+            x = dist(gen);
+        }
+        auto w = u;
+        quickSort<BlockPartition>(u, 0, n - 1);
+        sr::sort(w);
+        assert(u == w);
+    }
+
+    std::uniform_int_distribution<int> intDist;
+    std::uniform_real_distribution<double> doubleDist;
+    std::uniform_int_distribution<std::int64_t> keyDist;
+    benchmark<int>("int", [&] { return intDist(gen); });
+    benchmark<double>("double", [&] { return doubleDist(gen); });
+    benchmark<Record>("16-byte record", [&] { return Record {keyDist(gen), keyDist(gen)}; });
 }
\ No newline at end of file
@@ -1,10 +1,14 @@
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <iostream>
 #include <random>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <ranges>
 
@@ -36,6 +40,119 @@ void bucketSort(std::vector<std::string>& A, size_t pos) {
     }
 }
 
+// 0 marks the end of the string, so shorter strings sort first
+inline std::uint16_t charAt(std::string_view s, size_t d) {
+    return d < s.size() ? static_cast<std::uint16_t>(static_cast<unsigned char>(s[d]) + 1) : 0;
+}
+
+constexpr size_t FLAG_BUCKETS = 257;
+constexpr size_t MULTIKEY_CUTOFF = 64;
+constexpr size_t INSERTION_CUTOFF = 8;
+
+// all strings share their first d characters
+void insertionSort(std::span<std::string_view> A, size_t d) {
+    for (size_t j = 1; j < A.size(); j++) {
+        std::string_view key = A[j];
+        size_t i = j;
+        while (i > 0 && key.substr(d) < A[i - 1].substr(d)) {
+            A[i] = A[i - 1];
+            i--;
+        }
+        A[i] = key;
+    }
+}
+
+void multikeyQuickSort(std::span<std::string_view> A, size_t d) {
+    while (A.size() > INSERTION_CUTOFF) {
+        size_t n = A.size();
+        std::uint16_t a = charAt(A[0], d);
+        std::uint16_t b = charAt(A[n / 2], d);
+        std::uint16_t c = charAt(A[n - 1], d);
+        std::uint16_t v = std::max(std::min(a, b), std::min(std::max(a, b), c));
+
+        size_t lt = 0;
+        size_t gt = n;
+        size_t i = 0;
+        while (i < gt) {
+            std::uint16_t ch = charAt(A[i], d);
+            if (ch < v) {
+                std::swap(A[lt++], A[i++]);
+            } else if (ch > v) {
+                std::swap(A[i], A[--gt]);
+            } else {
+                i++;
+            }
+        }
+        multikeyQuickSort(A.subspan(0, lt), d);
+        multikeyQuickSort(A.subspan(gt), d);
+        if (v == 0) {
+            return;
+        }
+        A = A.subspan(lt, gt - lt);
+        d++;
+    }
+    insertionSort(A, d);
+}
+
+// in-place MSD radix sort: each pass counts the bucket sizes, then permutes elements
+// into their buckets along cycles; the character of each element is read once per pass
+void americanFlagSort(std::span<std::string_view> A) {
+    struct Range {
+        size_t lo;
+        size_t hi;
+        size_t d;
+    };
+    std::vector<std::uint16_t> cache (A.size());
+    std::vector<Range> work {{0, A.size(), 0}};
+    std::array<size_t, FLAG_BUCKETS> next;
+    std::array<size_t, FLAG_BUCKETS> end;
+    while (!work.empty()) {
+        auto [lo, hi, d] = work.back();
+        work.pop_back();
+        if (hi - lo < MULTIKEY_CUTOFF) {
+            multikeyQuickSort(A.subspan(lo, hi - lo), d);
+            continue;
+        }
+
+        std::array<size_t, FLAG_BUCKETS> count {};
+        for (size_t i = lo; i < hi; i++) {
+            cache[i] = charAt(A[i], d);
+            count[cache[i]]++;
+        }
+        size_t sum = lo;
+        for (size_t b = 0; b < FLAG_BUCKETS; b++) {
+            next[b] = sum;
+            sum += count[b];
+            end[b] = sum;
+        }
+
+        for (size_t b = 0; b < FLAG_BUCKETS; b++) {
+            while (next[b] < end[b]) {
+                size_t i = next[b];
+                std::uint16_t c = cache[i];
+                if (c != b) {
+                    std::string_view s = A[i];
+                    do {
+                        size_t j = next[c]++;
+                        std::swap(s, A[j]);
+                        std::swap(c, cache[j]);
+                    } while (c != b);
+                    A[i] = s;
+                }
+                next[b]++;
+            }
+        }
+
+        // bucket 0 holds strings that ended at d, which are all equal
+        for (size_t b = 1; b < FLAG_BUCKETS; b++) {
+            size_t start = end[b] - count[b];
+            if (count[b] > 1) {
+                work.push_back({start, end[b], d + 1});
+            }
+        }
+    }
+}
+
 std::string make_random_string() {
     std::string res;
     std::uniform_int_distribution<> char_dist(0, 25);
@@ -47,33 +164,69 @@ std::string make_random_string() {
     return res;
 }
 
-int main() {
-    constexpr size_t N = 100;
+std::string make_log_key() {
+    static const std::string services[] = {"api", "auth", "billing", "ingest", "search"};
+    std::uniform_int_distribution<> service_dist(0, 4);
+    std::uniform_int_distribution<> id_dist(0, 999'999);
+    std::uniform_int_distribution<> level_dist(0, 3);
+    return services[service_dist(gen)] + "/" + std::to_string(level_dist(gen)) + "/" + std::to_string(id_dist(gen));
+}
+
+template <typename MakeString>
+void benchmark(const char* name, size_t n, MakeString make, bool withBucketSort) {
     std::vector<std::string> A;
-    for (size_t i = 0; i < N; i++) {
-        A.push_back(make_random_string());
+    for (size_t i = 0; i < n; i++) {
+        A.push_back(make());
     }
-    constexpr size_t TRIALS = 20;
-    crn::milliseconds DT1 (0), DT2(0);
+    std::vector<std::string_view> views (A.begin(), A.end());
+    constexpr size_t TRIALS = 5;
+    crn::microseconds DT1 (0), DT2(0), DT3(0), DT4(0);
     for (size_t t = 0; t < TRIALS; t++) {
         sr::shuffle(A, gen);
+        auto B = A;
         auto t1 = crn::steady_clock::now();
-        sr::sort(A);
+        sr::sort(B);
         auto t2 = crn::steady_clock::now();
-        auto dt1 = crn::duration_cast<crn::milliseconds>(t2 - t1);
-        DT1 += dt1;
-        assert(sr::is_sorted(A));
-        sr::shuffle(A, gen);
-        auto t3 = crn::steady_clock::now();
-        bucketSort(A, 0);
-        auto t4 = crn::steady_clock::now();
-        auto dt2 = crn::duration_cast<crn::milliseconds>(t4 - t3);
-        DT2 += dt2;
-        assert(sr::is_sorted(A));
+        DT1 += crn::duration_cast<crn::microseconds>(t2 - t1);
+
+        if (withBucketSort) {
+            auto C = A;
+            auto t3 = crn::steady_clock::now();
+            bucketSort(C, 0);
+            auto t4 = crn::steady_clock::now();
+            DT2 += crn::duration_cast<crn::microseconds>(t4 - t3);
+            assert(C == B);
+        }
+
+        views.assign(A.begin(), A.end());
+        auto t5 = crn::steady_clock::now();
+        sr::sort(views);
+        auto t6 = crn::steady_clock::now();
+        DT3 += crn::duration_cast<crn::microseconds>(t6 - t5);
+
+        views.assign(A.begin(), A.end());
+        auto t7 = crn::steady_clock::now();
+        americanFlagSort(views);
+        auto t8 = crn::steady_clock::now();
+        DT4 += crn::duration_cast<crn::microseconds>(t8 - t7);
+        assert(sr::equal(views, B));
     }
 
-    std::cout << "Sorting " << N << " elements in using std::sort : " << DT1.count() / TRIALS << "ms\n";
-    std::cout << "Sorting " << N << " elements in using recursive bucket sort : " << DT2.count() / TRIALS << "ms\n";
+    std::cout << "Sorting " << n << " " << name << " using std::sort : " << DT1.count() / TRIALS << "us\n";
+    if (withBucketSort) {
+        std::cout << "Sorting " << n << " " << name << " using recursive bucket sort : " << DT2.count() / TRIALS << "us\n";
+    }
+    std::cout << "Sorting " << n << " " << name << " using std::sort on string_view : " << DT3.count() / TRIALS << "us\n";
+    std::cout << "Sorting " << n << " " << name << " using American flag sort : " << DT4.count() / TRIALS << "us\n";
+}
+
+int main() {
+    std::vector<std::string_view> v {"b", "", "abc", "ab", "abd", "a", "", "b"};
+    americanFlagSort(v);
+    assert(sr::is_sorted(v));
+
+    benchmark("random short strings", 1'000'000, make_random_string, true);
+    benchmark("log keys", 1'000'000, make_log_key, false);
 
 
 }
\ No newline at end of file
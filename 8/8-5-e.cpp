@@ -1,10 +1,12 @@
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
 #include <random>
-#include <queue>
+#include <span>
 #include <utility>
 #include <vector>
 #include <ranges>
@@ -13,35 +15,99 @@ namespace sr = std::ranges;
 
 std::mt19937 gen(std::random_device{}());
 
-using it_p_t = std::pair<std::vector<int>::const_iterator,
-        std::vector<int>::const_iterator>;
+// tournament tree over k sorted sources: each internal node keeps the loser of the match
+// played there (with a copy of its current key) and node 0 keeps the overall winner, so
+// advancing the winner replays only its own leaf-to-root path with one comparison per level.
+// An exhausted source loses every match, so no sentinel key is needed. Equal keys are taken
+// from the lower source first.
+template <typename T, typename Comp = std::less<T>>
+class LoserTree {
+public:
+    explicit LoserTree(const std::vector<std::span<const T>>& runs, Comp comp = Comp())
+        : k {std::bit_ceil(std::max<size_t>(runs.size(), 2))}, cur (k), end (k), tree (k), comp {comp} {
+        for (size_t i = 0; i < runs.size(); i++) {
+            cur[i] = runs[i].data();
+            end[i] = runs[i].data() + runs[i].size();
+        }
+        std::vector<Node> winner (2 * k);
+        for (size_t i = 0; i < k; i++) {
+            winner[k + i] = leaf(i);
+        }
+        for (size_t node = k - 1; node > 0; node--) {
+            const Node& a = winner[2 * node];
+            const Node& b = winner[2 * node + 1];
+            if (beats(a, b)) {
+                winner[node] = a;
+                tree[node] = b;
+            } else {
+                winner[node] = b;
+                tree[node] = a;
+            }
+        }
+        tree[0] = winner[1];
+    }
 
-std::vector<int> mergeKLists(const std::vector<std::vector<int>>& lists) {
-    auto nodeComp = [](it_p_t& na, it_p_t& nb) {
-        return *(na.first) > *(nb.first);
+    bool empty() const {
+        return tree[0].done;
+    }
+
+    // writes merged elements until out is full or every source is exhausted; returns the count
+    size_t merge(std::span<T> out) {
+        size_t n = 0;
+        while (n < out.size() && !tree[0].done) {
+            size_t s = tree[0].source;
+            out[n++] = std::move(tree[0].key);
+            ++cur[s];
+            Node w = leaf(s);
+            for (size_t node = (s + k) / 2; node > 0; node /= 2) {
+                if (beats(tree[node], w)) {
+                    std::swap(tree[node], w);
+                }
+            }
+            tree[0] = std::move(w);
+        }
+        return n;
+    }
+
+private:
+    struct Node {
+        T key {};
+        size_t source = 0;
+        bool done = true;
     };
-    std::priority_queue<it_p_t, std::vector<it_p_t>, decltype(nodeComp)> iters(nodeComp);
-    std::vector<int> merged_vec;
-    if (lists.empty()) return merged_vec;
-    for (const auto& list : lists) {
-        if (!list.empty()) {
-            iters.emplace(list.cbegin(), list.cend());
+
+    size_t k;
+    std::vector<const T*> cur;
+    std::vector<const T*> end;
+    std::vector<Node> tree;
+    Comp comp;
+
+    Node leaf(size_t s) const {
+        if (cur[s] == end[s]) {
+            return {T {}, s, true};
         }
+        return {*cur[s], s, false};
     }
-    if (iters.empty()) return merged_vec;
-    auto curr_iter = iters.top();
-    merged_vec.push_back(*(curr_iter.first));
-    while (curr_iter.first != curr_iter.second) {
-        iters.pop();
-        if (++curr_iter.first != curr_iter.second) {
-            iters.push(curr_iter);
+
+    bool beats(const Node& a, const Node& b) const {
+        if (a.done || b.done) {
+            return !a.done;
         }
-        if (iters.empty()) {
-            break;
+        if (comp(a.key, b.key)) {
+            return true;
         }
-        curr_iter = iters.top();
-        merged_vec.push_back(*(iters.top().first));
+        return !comp(b.key, a.key) && a.source < b.source;
+    }
+};
+
+std::vector<int> mergeKLists(const std::vector<std::vector<int>>& lists) {
+    std::vector<std::span<const int>> runs (lists.begin(), lists.end());
+    size_t total = 0;
+    for (const auto& list : lists) {
+        total += list.size();
     }
+    std::vector<int> merged_vec (total);
+    LoserTree<int>(runs).merge(merged_vec);
     return merged_vec;
 }
 
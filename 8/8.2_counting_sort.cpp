@@ -1,9 +1,19 @@
 #include <algorithm>
+#include <barrier>
 #include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <thread>
 #include <vector>
 #include <ranges>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
+
+std::mt19937 gen(std::random_device{}());
 
 std::vector<size_t> countingSort(std::vector<size_t>& A, size_t k) {
     assert(*sr::max_element(A) <= k);
@@ -22,8 +32,108 @@ std::vector<size_t> countingSort(std::vector<size_t>& A, size_t k) {
     return B;
 }
 
+// each thread histograms its own slice, the histograms are merged by an exclusive prefix sum
+// ordered by (key, thread), and each thread then scatters its slice into the slots it owns
+template <typename T, typename KeyFn = std::identity>
+std::vector<T> parallelCountingSort(const std::vector<T>& A, size_t k, KeyFn key = {},
+                                    size_t threadCount = std::thread::hardware_concurrency()) {
+    size_t n = A.size();
+    threadCount = std::clamp<size_t>(threadCount, 1, std::max<size_t>(n, 1));
+    size_t sliceSize = (n + threadCount - 1) / threadCount;
+    std::vector<T> B (n);
+    std::vector<std::vector<size_t>> C (threadCount, std::vector<size_t>(k + 1));
+
+    auto prefixSum = [&]() noexcept {
+        size_t sum = 0;
+        for (size_t v = 0; v <= k; v++) {
+            for (auto& c : C) {
+                size_t count = c[v];
+                c[v] = sum;
+                sum += count;
+            }
+        }
+    };
+    std::barrier sync (static_cast<std::ptrdiff_t>(threadCount), prefixSum);
+
+    auto work = [&](size_t t) {
+        size_t b = std::min(t * sliceSize, n);
+        size_t e = std::min(b + sliceSize, n);
+        auto& c = C[t];
+        for (size_t i = b; i < e; i++) {
+            size_t v = static_cast<size_t>(std::invoke(key, A[i]));
+            assert(v <= k);
+            c[v]++;
+        }
+        sync.arrive_and_wait();
+        for (size_t i = b; i < e; i++) {
+            B[c[static_cast<size_t>(std::invoke(key, A[i]))]++] = A[i];
+        }
+    };
+    {
+        std::vector<std::jthread> threads;
+        for (size_t t = 1; t < threadCount; t++) {
+            threads.emplace_back(work, t);
+        }
+        work(0);
+    }
+    return B;
+}
+
+enum class Status : std::uint8_t {
+    Ok,
+    Redirect,
+    ClientError,
+    ServerError,
+};
+
+struct Event {
+    Status status;
+    std::uint32_t id;
+};
+
 int main() {
     std::vector<size_t> v {3, 2, 6, 1, 5, 4};
     v = countingSort(v, 6);
     assert(sr::is_sorted(v));
+
+    std::vector<size_t> w {3, 2, 6, 1, 5, 4, 0, 6};
+    w = parallelCountingSort(w, 6, std::identity {}, 3);
+    assert(sr::is_sorted(w));
+
+    std::vector<Event> events (100'000);
+    std::uniform_int_distribution<> statusDist(0, 3);
+    for (std::uint32_t i = 0; i < events.size(); i++) {
+        events[i] = {static_cast<Status>(statusDist(gen)), i};
+    }
+    auto byStatus = parallelCountingSort(events, 3, &Event::status, 4);
+    for (size_t i = 1; i < byStatus.size(); i++) {
+        assert(byStatus[i - 1].status < byStatus[i].status ||
+               (byStatus[i - 1].status == byStatus[i].status && byStatus[i - 1].id < byStatus[i].id));
+    }
+
+    constexpr size_t N = 20'000'000;
+    constexpr size_t K = 255;
+    std::vector<size_t> A (N);
+    std::uniform_int_distribution<size_t> dist(0, K);
+    for (auto& n : A) {
+        n = dist(gen);
+    }
+    auto t1 = crn::steady_clock::now();
+    auto B1 = countingSort(A, K);
+    auto t2 = crn::steady_clock::now();
+    std::cout << "Counting sort of " << N << " keys in [0, " << K << "] : "
+              << crn::duration_cast<crn::microseconds>(t2 - t1).count() << "us\n";
+
+    size_t maxThreads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t threads = 1; ; threads = std::min(threads * 2, maxThreads)) {
+        auto t3 = crn::steady_clock::now();
+        auto B2 = parallelCountingSort(A, K, std::identity {}, threads);
+        auto t4 = crn::steady_clock::now();
+        assert(B1 == B2);
+        std::cout << "Parallel counting sort of " << N << " keys in [0, " << K << "] with " << threads << " threads : "
+                  << crn::duration_cast<crn::microseconds>(t4 - t3).count() << "us\n";
+        if (threads == maxThreads) {
+            break;
+        }
+    }
 }
\ No newline at end of file
@@ -1,13 +1,21 @@
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <random>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include <ranges>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
 
 std::mt19937 gen(std::random_device{}());
 
@@ -22,34 +30,159 @@ void radixSort(std::vector<size_t>& A, size_t d) {
     }
 }
 
+// maps a key to an unsigned integer with the same ordering
+template <typename K>
+auto radixKey(K k) {
+    constexpr size_t BITS = sizeof(K) * 8;
+    if constexpr (std::is_floating_point_v<K>) {
+        using U = std::conditional_t<sizeof(K) == 4, std::uint32_t, std::uint64_t>;
+        U u = std::bit_cast<U>(k);
+        return (u >> (BITS - 1)) ? ~u : u | (U {1} << (BITS - 1));
+    } else if constexpr (std::is_signed_v<K>) {
+        using U = std::make_unsigned_t<K>;
+        return static_cast<U>(static_cast<U>(k) ^ (U {1} << (BITS - 1)));
+    } else {
+        return k;
+    }
+}
+
+template <size_t DigitBits = 8, typename T, typename KeyFn = std::identity>
+void lsdRadixSort(std::vector<T>& A, KeyFn key = {}) {
+    using U = decltype(radixKey(key(std::declval<const T&>())));
+    constexpr size_t RADIX = size_t {1} << DigitBits;
+    constexpr U MASK = static_cast<U>(RADIX - 1);
+    constexpr size_t PASSES = (sizeof(U) * 8 + DigitBits - 1) / DigitBits;
+    size_t n = A.size();
+    if (n < 2) {
+        return;
+    }
+
+    std::vector<std::array<size_t, RADIX>> C (PASSES);
+    for (const auto& a : A) {
+        U u = radixKey(key(a));
+        for (size_t d = 0; d < PASSES; d++) {
+            C[d][(u >> (d * DigitBits)) & MASK]++;
+        }
+    }
+
+    std::vector<T> B (n);
+    std::vector<T>* src = &A;
+    std::vector<T>* dst = &B;
+    U first = radixKey(key(A[0]));
+    for (size_t d = 0; d < PASSES; d++) {
+        size_t shift = d * DigitBits;
+        // every key shares this digit, so the pass would be the identity permutation
+        if (C[d][(first >> shift) & MASK] == n) {
+            continue;
+        }
+        size_t sum = 0;
+        for (auto& c : C[d]) {
+            size_t count = c;
+            c = sum;
+            sum += count;
+        }
+        for (auto& a : *src) {
+            (*dst)[C[d][(radixKey(key(a)) >> shift) & MASK]++] = std::move(a);
+        }
+        std::swap(src, dst);
+    }
+    if (src != &A) {
+        A.swap(B);
+    }
+}
+
+struct Record {
+    std::uint32_t id;
+    float score;
+};
+
+template <typename T, typename Sort>
+crn::microseconds timeSort(std::vector<T> A, Sort sort) {
+    auto t1 = crn::steady_clock::now();
+    sort(A);
+    auto t2 = crn::steady_clock::now();
+    return crn::duration_cast<crn::microseconds>(t2 - t1);
+}
+
 int main() {
+    std::vector<int> s {3, -2, 6, -100, 5, 0, std::numeric_limits<int>::min(), std::numeric_limits<int>::max()};
+    lsdRadixSort(s);
+    assert(sr::is_sorted(s));
+    std::vector<double> f {0.5, -0.0, -1e300, 3.25, -2.5, 1e-300, 0.0, 7.0};
+    lsdRadixSort<11>(f);
+    assert(sr::is_sorted(f));
+
     constexpr size_t N = 50'000;
     std::vector<size_t> A (N);
     std::uniform_int_distribution<> dist(0, 99);
     for (auto& n : A) {
         n = dist(gen);
     }
-    constexpr size_t TRIALS = 1'000;
-    crn::milliseconds DT1 (0), DT2(0);
+    constexpr size_t TRIALS = 100;
+    crn::microseconds DT1 (0), DT2(0), DT3(0);
     for (size_t t = 0; t < TRIALS; t++) {
         sr::shuffle(A, gen);
         auto t1 = crn::steady_clock::now();
         sr::sort(A);
         auto t2 = crn::steady_clock::now();
-        auto dt1 = crn::duration_cast<crn::milliseconds>(t2 - t1);
+        auto dt1 = crn::duration_cast<crn::microseconds>(t2 - t1);
         DT1 += dt1;
         assert(sr::is_sorted(A));
         sr::shuffle(A, gen);
         auto t3 = crn::steady_clock::now();
         radixSort(A, 2);
         auto t4 = crn::steady_clock::now();
-        auto dt2 = crn::duration_cast<crn::milliseconds>(t4 - t3);
+        auto dt2 = crn::duration_cast<crn::microseconds>(t4 - t3);
         DT2 += dt2;
         assert(sr::is_sorted(A));
+        sr::shuffle(A, gen);
+        auto t5 = crn::steady_clock::now();
+        lsdRadixSort(A);
+        auto t6 = crn::steady_clock::now();
+        auto dt3 = crn::duration_cast<crn::microseconds>(t6 - t5);
+        DT3 += dt3;
+        assert(sr::is_sorted(A));
     }
 
-    std::cout << "Sorting " << N << " elements in range of [0, 99] using std::sort : " << DT1.count() / TRIALS << "ms\n";
-    std::cout << "Sorting " << N << " elements in range of [0, 99] using radix sort : " << DT2.count() / TRIALS << "ms\n";
+    std::cout << "Sorting " << N << " elements in range of [0, 99] using std::sort : " << DT1.count() / TRIALS << "us\n";
+    std::cout << "Sorting " << N << " elements in range of [0, 99] using decimal radix sort : " << DT2.count() / TRIALS << "us\n";
+    std::cout << "Sorting " << N << " elements in range of [0, 99] using LSD radix sort : " << DT3.count() / TRIALS << "us\n";
+
+    constexpr size_t M = 10'000'000;
+    std::vector<std::int64_t> ints (M);
+    std::uniform_int_distribution<std::int64_t> intDist;
+    for (auto& n : ints) {
+        n = intDist(gen);
+    }
+    std::vector<double> doubles (M);
+    std::normal_distribution<> doubleDist(0.0, 1e6);
+    for (auto& d : doubles) {
+        d = doubleDist(gen);
+    }
+    std::vector<Record> records (M);
+    std::uniform_real_distribution<float> scoreDist(-1.0f, 1.0f);
+    for (std::uint32_t i = 0; i < M; i++) {
+        records[i] = {i, scoreDist(gen)};
+    }
+
+    auto bySort = [](auto& v) { sr::sort(v); };
+    auto byRadix8 = [](auto& v) { lsdRadixSort<8>(v); assert(sr::is_sorted(v)); };
+    auto byRadix11 = [](auto& v) { lsdRadixSort<11>(v); assert(sr::is_sorted(v)); };
+    std::cout << "Sorting " << M << " signed 64-bit integers using std::sort : " << timeSort(ints, bySort).count() << "us\n";
+    std::cout << "Sorting " << M << " signed 64-bit integers using 8-bit LSD radix sort : " << timeSort(ints, byRadix8).count() << "us\n";
+    std::cout << "Sorting " << M << " signed 64-bit integers using 11-bit LSD radix sort : " << timeSort(ints, byRadix11).count() << "us\n";
+    std::cout << "Sorting " << M << " doubles using std::sort : " << timeSort(doubles, bySort).count() << "us\n";
+    std::cout << "Sorting " << M << " doubles using 8-bit LSD radix sort : " << timeSort(doubles, byRadix8).count() << "us\n";
+    std::cout << "Sorting " << M << " doubles using 11-bit LSD radix sort : " << timeSort(doubles, byRadix11).count() << "us\n";
+
+    auto byScore = [](const Record& r) { return r.score; };
+    auto recordsBySort = [](auto& v) { sr::stable_sort(v, {}, &Record::score); };
+    auto recordsByRadix = [&byScore](auto& v) {
+        lsdRadixSort<11>(v, byScore);
+        assert(sr::is_sorted(v, {}, &Record::score));
+    };
+    std::cout << "Sorting " << M << " records by float field using std::stable_sort : " << timeSort(records, recordsBySort).count() << "us\n";
+    std::cout << "Sorting " << M << " records by float field using 11-bit LSD radix sort : " << timeSort(records, recordsByRadix).count() << "us\n";
 
 
 }
\ No newline at end of file
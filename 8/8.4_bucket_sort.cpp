@@ -2,6 +2,7 @@
 #include <cassert>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
 #include <iterator>
 #include <random>
 #include <vector>
@@ -11,6 +12,8 @@
 namespace sr = std::ranges;
 namespace crn = std::chrono;
 
+std::mt19937 gen(std::random_device{}());
+
 template <typename T, typename Comp = std::greater<T>>
 void insertionSort(std::vector<T>& A, Comp comp = Comp()) {
     for (size_t j = 1; j < A.size(); j++) {
@@ -38,35 +41,122 @@ void bucketSort(std::vector<double>& A) {
     }
 }
 
+constexpr size_t L1_BYTES = 32 * 1024;
+constexpr size_t OVERSAMPLING = 16;
+
+// number of splitters not greater than x, found without data-dependent branches
+template <typename T>
+size_t bucketIndex(const std::vector<T>& splitters, const T& x) {
+    const T* base = splitters.data();
+    size_t len = splitters.size();
+    while (len > 1) {
+        size_t half = len / 2;
+        base += !(x < base[half - 1]) * half;
+        len -= half;
+    }
+    return (base - splitters.data()) + !(x < *base);
+}
+
+// splitters come from a sorted random sample, so buckets stay about the same size on skewed input;
+// the bucket count is chosen so a bucket fills about half of L1 while it is being sorted
+template <typename T>
+void sampleBucketSort(std::vector<T>& A) {
+    size_t n = A.size();
+    size_t bucketSize = std::max<size_t>(L1_BYTES / (2 * sizeof(T)), 1);
+    size_t m = (n + bucketSize - 1) / bucketSize;
+    if (m <= 1) {
+        sr::sort(A);
+        return;
+    }
+
+    std::vector<T> sample (m * OVERSAMPLING);
+    std::uniform_int_distribution<size_t> idx(0, n - 1);
+    for (auto& s : sample) {
+        s = A[idx(gen)];
+    }
+    sr::sort(sample);
+    std::vector<T> splitters (m - 1);
+    for (size_t i = 0; i + 1 < m; i++) {
+        splitters[i] = sample[(i + 1) * OVERSAMPLING - 1];
+    }
+
+    std::vector<std::uint32_t> bucketOf (n);
+    std::vector<size_t> C (m + 1);
+    for (size_t i = 0; i < n; i++) {
+        bucketOf[i] = static_cast<std::uint32_t>(bucketIndex(splitters, A[i]));
+        C[bucketOf[i] + 1]++;
+    }
+    for (size_t b = 1; b <= m; b++) {
+        C[b] += C[b - 1];
+    }
+    std::vector<T> B (n);
+    std::vector<size_t> next (C.begin(), C.end() - 1);
+    for (size_t i = 0; i < n; i++) {
+        B[next[bucketOf[i]]++] = std::move(A[i]);
+    }
+
+    for (size_t b = 0; b < m; b++) {
+        auto first = B.begin() + C[b];
+        auto last = B.begin() + C[b + 1];
+        // a value sampled as several splitters in a row is frequent enough to fill its bucket alone
+        if (b >= 2 && !(splitters[b - 2] < splitters[b - 1]) &&
+            std::all_of(first, last, [&](const T& x) { return !(splitters[b - 1] < x); })) {
+            continue;
+        }
+        std::sort(first, last);
+    }
+    A.swap(B);
+}
+
+template <typename Sort>
+crn::microseconds timeSort(const std::vector<double>& input, Sort sort) {
+    auto A = input;
+    auto t1 = crn::steady_clock::now();
+    sort(A);
+    auto t2 = crn::steady_clock::now();
+    assert(sr::is_sorted(A));
+    return crn::duration_cast<crn::microseconds>(t2 - t1);
+}
+
 int main() {
-    std::mt19937 gen(std::random_device{}());
     std::uniform_real_distribution<> dist(0.0, 1.0);
     constexpr size_t N = 50'000;
     std::vector<double> A (N);
     for (auto& n : A) {
         n = dist(gen);
     }
-    constexpr size_t TRIALS = 1'000;
-    crn::milliseconds DT1 (0), DT2(0);
+    constexpr size_t TRIALS = 100;
+    crn::microseconds DT1 (0), DT2(0), DT3(0);
     for (size_t t = 0; t < TRIALS; t++) {
         sr::shuffle(A, gen);
-        auto t1 = crn::steady_clock::now();
-        sr::sort(A);
-        auto t2 = crn::steady_clock::now();
-        auto dt1 = crn::duration_cast<crn::milliseconds>(t2 - t1);
-        DT1 += dt1;
-        assert(sr::is_sorted(A));
-        sr::shuffle(A, gen);
-        auto t3 = crn::steady_clock::now();
-        bucketSort(A);
-        auto t4 = crn::steady_clock::now();
-        auto dt2 = crn::duration_cast<crn::milliseconds>(t4 - t3);
-        DT2 += dt2;
-        assert(sr::is_sorted(A));
+        DT1 += timeSort(A, [](auto& v) { sr::sort(v); });
+        DT2 += timeSort(A, [](auto& v) { bucketSort(v); });
+        DT3 += timeSort(A, [](auto& v) { sampleBucketSort(v); });
     }
 
-    std::cout << "Sorting " << N << " elements in [0, 1] using std::sort : " << DT1.count() / TRIALS << "ms\n";
-    std::cout << "Sorting " << N << " elements in [0, 1] using bucket sort : " << DT2.count() / TRIALS << "ms\n";
+    std::cout << "Sorting " << N << " elements in [0, 1] using std::sort : " << DT1.count() / TRIALS << "us\n";
+    std::cout << "Sorting " << N << " elements in [0, 1] using bucket sort : " << DT2.count() / TRIALS << "us\n";
+    std::cout << "Sorting " << N << " elements in [0, 1] using sample bucket sort : " << DT3.count() / TRIALS << "us\n";
+
+    constexpr size_t M = 10'000'000;
+    std::vector<double> uniform (M), skewed (M), normal (M), duplicates (M);
+    std::normal_distribution<> normalDist(0.0, 1.0);
+    std::uniform_int_distribution<> fewDist(0, 9);
+    for (size_t i = 0; i < M; i++) {
+        uniform[i] = dist(gen);
+        skewed[i] = std::pow(dist(gen), 8);
+        normal[i] = normalDist(gen);
+        duplicates[i] = fewDist(gen);
+    }
+    std::pair<const char*, const std::vector<double>*> inputs[] = {
+        {"uniform", &uniform}, {"skewed", &skewed}, {"normal", &normal}, {"few distinct", &duplicates}
+    };
+    for (auto [name, input] : inputs) {
+        std::cout << "Sorting " << M << " " << name << " elements using std::sort : "
+                  << timeSort(*input, [](auto& v) { sr::sort(v); }).count() << "us\n";
+        std::cout << "Sorting " << M << " " << name << " elements using sample bucket sort : "
+                  << timeSort(*input, [](auto& v) { sampleBucketSort(v); }).count() << "us\n";
+    }
 
 
 }
\ No newline at end of file
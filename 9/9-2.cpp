@@ -1,13 +1,20 @@
 #include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <numbers>
+#include <random>
+#include <thread>
 #include <utility>
 #include <numeric>
 #include <vector>
 #include <ranges>
 
 namespace sr = std::ranges;
+namespace crn = std::chrono;
 
 double weightedMedian1(const std::vector<std::pair<double, double>>& A) {
     auto B = A;
@@ -64,6 +71,170 @@ std::pair<double, double> weightedMedian2d(const std::vector<std::tuple<double,
 }
 
 
+// Merging t-digest (Dunning & Ertl): a mergeable sketch of a weighted stream that answers any
+// quantile in bounded memory. Samples are summarised as centroids (mean, weight) sorted by mean.
+// A centroid covering the quantile range [q0, q1] may only absorb more samples while
+// k(q1) - k(q0) <= 1 for the scale function k(q) = compression / (2 pi) * asin(2q - 1), which is
+// steep near 0 and 1: centroids around the median hold many samples, those in the tails few.
+// The digest thus keeps at most about compression centroids however long the stream is.
+class TDigest {
+    struct Centroid {
+        double mean;
+        double weight;
+        bool single; // all samples have the same value, so the mass sits at one point
+    };
+
+    double compression;
+    std::size_t bufferSize;
+    std::vector<Centroid> centroids;
+    std::vector<Centroid> buffer;
+    double total = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+
+    double K(double q) const {
+        return compression / (2 * std::numbers::pi) * std::asin(2 * std::clamp(q, 0.0, 1.0) - 1);
+    }
+
+    double KInverse(double k) const {
+        if (k >= compression / 4) {
+            return 1.0;
+        }
+        return (std::sin(k * 2 * std::numbers::pi / compression) + 1) / 2;
+    }
+
+    // one merging pass over the sorted centroids and buffered samples
+    void Compress() {
+        if (buffer.empty()) {
+            return;
+        }
+        buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+        sr::sort(buffer, {}, &Centroid::mean);
+        centroids.clear();
+        double done = 0.0;
+        double limit = total * KInverse(K(0.0) + 1);
+        Centroid curr = buffer[0];
+        for (std::size_t i = 1; i < buffer.size(); i++) {
+            const auto& c = buffer[i];
+            if (done + curr.weight + c.weight <= limit) {
+                curr.single = curr.single && c.single && curr.mean == c.mean;
+                curr.weight += c.weight;
+                curr.mean += (c.mean - curr.mean) * c.weight / curr.weight;
+            } else {
+                done += curr.weight;
+                centroids.push_back(curr);
+                limit = total * KInverse(K(done / total) + 1);
+                curr = c;
+            }
+        }
+        centroids.push_back(curr);
+        buffer.clear();
+    }
+
+public:
+    explicit TDigest(double compression = 200.0)
+        : compression {compression}, bufferSize {static_cast<std::size_t>(8 * compression)} {
+        assert(compression >= 10.0);
+        buffer.reserve(bufferSize);
+    }
+
+    void Add(double x, double w = 1.0) {
+        assert(w >= 0.0);
+        if (w == 0.0) {
+            return;
+        }
+        buffer.push_back({x, w, true});
+        total += w;
+        min = std::min(min, x);
+        max = std::max(max, x);
+        if (buffer.size() >= bufferSize) {
+            Compress();
+        }
+    }
+
+    void Merge(const TDigest& other) {
+        buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+        buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+        total += other.total;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+        if (buffer.size() >= bufferSize) {
+            Compress();
+        }
+    }
+
+    // a value such that the samples below it weigh about q * TotalWeight(); a point mass that
+    // straddles the target is returned as is, like weightedMedian1 does, otherwise the answer
+    // is interpolated between the neighbouring centroids
+    double Quantile(double q) {
+        assert(0.0 <= q && q <= 1.0 && total > 0.0);
+        Compress();
+        double target = q * total;
+        double cum = 0.0;
+        double prevAnchor = 0.0;
+        double prevValue = min;
+        for (const auto& c : centroids) {
+            double lo = c.single ? cum : cum + c.weight / 2;
+            double hi = c.single ? cum + c.weight : cum + c.weight / 2;
+            if (target < lo) {
+                return prevValue + (c.mean - prevValue) * (target - prevAnchor) / (lo - prevAnchor);
+            }
+            if (target < hi) {
+                return c.mean;
+            }
+            prevAnchor = hi;
+            prevValue = c.mean;
+            cum += c.weight;
+        }
+        if (total <= prevAnchor) {
+            return max;
+        }
+        return prevValue + (max - prevValue) * (target - prevAnchor) / (total - prevAnchor);
+    }
+
+    double TotalWeight() const {
+        return total;
+    }
+
+    std::size_t CentroidCount() {
+        Compress();
+        return centroids.size();
+    }
+};
+
+double weightedMedian3(const std::vector<std::pair<double, double>>& A, double compression = 200.0) {
+    TDigest digest (compression);
+    for (const auto& [x, w] : A) {
+        digest.Add(x, w);
+    }
+    return digest.Quantile(0.5);
+}
+
+// merges per-thread digests pairwise, one round of independent merges at a time
+TDigest mergeAll(std::vector<TDigest> digests) {
+    assert(!digests.empty());
+    for (std::size_t step = 1; step < digests.size(); step *= 2) {
+        std::vector<std::jthread> workers;
+        for (std::size_t i = 0; i + step < digests.size(); i += 2 * step) {
+            workers.emplace_back([&digests, i, step] {
+                digests[i].Merge(digests[i + step]);
+            });
+        }
+    }
+    return std::move(digests[0]);
+}
+
+// how far q is from the quantile range [W(< x), W(<= x)] / W that x occupies in the sorted
+// weighted samples, with prefix[i] the weight of sorted[0..i)
+double rankError(const std::vector<std::pair<double, double>>& sorted, const std::vector<double>& prefix,
+                 double x, double q) {
+    auto lo = sr::lower_bound(sorted, x, {}, &std::pair<double, double>::first) - sorted.begin();
+    auto hi = sr::upper_bound(sorted, x, {}, &std::pair<double, double>::first) - sorted.begin();
+    double W = prefix.back();
+    return std::max({0.0, prefix[lo] / W - q, q - prefix[hi] / W});
+}
+
+
 int main() {
     std::vector<std::pair<double, double>> vw {{1, 0.1}, {3, 0.2}, {5, 0.3}, {7, 0.4}};
     std::cout << weightedMedian1(vw) << '\n';
@@ -74,6 +245,71 @@ int main() {
                                                          {5, 3, 0.3},
                                                          {7, 1, 0.4}};
     auto [x_m, y_m] = weightedMedian2d(xyw);
-    std::cout << x_m << ' ' << y_m;
+    std::cout << x_m << ' ' << y_m << '\n';
+    assert(weightedMedian3(vw) == weightedMedian1(vw));
+
+    // latencies weighted by request count, normalised to sum to 1 as weightedMedian1 expects
+    constexpr std::size_t N = 10'000'000;
+    std::mt19937 gen(std::random_device{}());
+    std::lognormal_distribution<> latency(6.0, 1.0);
+    std::uniform_real_distribution<> count(0.5, 1.5);
+    std::vector<std::pair<double, double>> samples (N);
+    double W = 0.0;
+    for (auto& [x, w] : samples) {
+        x = latency(gen);
+        w = count(gen);
+        W += w;
+    }
+    for (auto& p : samples) {
+        p.second /= W;
+    }
+
+    auto t1 = crn::steady_clock::now();
+    double exact = weightedMedian1(samples);
+    auto t2 = crn::steady_clock::now();
+    TDigest digest;
+    for (const auto& [x, w] : samples) {
+        digest.Add(x, w);
+    }
+    double approx = digest.Quantile(0.5);
+    auto t3 = crn::steady_clock::now();
+
+    std::size_t threads = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<TDigest> partial (threads);
+    {
+        std::vector<std::jthread> workers;
+        for (std::size_t t = 0; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (std::size_t i = t * N / threads; i < (t + 1) * N / threads; i++) {
+                    partial[t].Add(samples[i].first, samples[i].second);
+                }
+            });
+        }
+    }
+    auto merged = mergeAll(std::move(partial));
+    auto t4 = crn::steady_clock::now();
+
+    auto sorted = samples;
+    sr::sort(sorted);
+    std::vector<double> prefix {0.0};
+    for (const auto& p : sorted) {
+        prefix.push_back(prefix.back() + p.second);
+    }
+    assert(digest.CentroidCount() <= 200 && merged.CentroidCount() <= 200);
+    assert(std::abs(merged.TotalWeight() - 1.0) < 1e-9);
+    std::cout << "weighted median of " << N << " samples: exact " << exact << ", t-digest " << approx
+              << ", merged t-digest " << merged.Quantile(0.5) << '\n';
+    for (double q : {0.001, 0.01, 0.1, 0.5, 0.9, 0.99, 0.999}) {
+        double e1 = rankError(sorted, prefix, digest.Quantile(q), q);
+        double e2 = rankError(sorted, prefix, merged.Quantile(q), q);
+        std::cout << "  q = " << q << " : rank error " << e1 << ", merged " << e2 << '\n';
+        // a centroid at q spans about 1 / k'(q) = 2 pi sqrt(q (1 - q)) / compression of the weight
+        double bound = 2 * std::numbers::pi / 200 * std::sqrt(q * (1 - q));
+        assert(e1 <= bound && e2 <= bound);
+    }
+    std::cout << "  weightedMedian1 : " << crn::duration_cast<crn::milliseconds>(t2 - t1).count() << "ms\n";
+    std::cout << "  t-digest : " << crn::duration_cast<crn::milliseconds>(t3 - t2).count() << "ms\n";
+    std::cout << "  " << threads << " t-digests + merge : "
+              << crn::duration_cast<crn::milliseconds>(t4 - t3).count() << "ms\n";
 
 }
\ No newline at end of file
@@ -1,6 +1,24 @@
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
 #include <vector>
 
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAS_AVX2_KERNELS 1
+#include <immintrin.h>
+#define AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace crn = std::chrono;
+
 template <typename T>
 T minimum(const std::vector<T>& A) {
     T minValue = A[0];
@@ -23,6 +41,476 @@ T maximum(const std::vector<T>& A) {
     return maxValue;
 }
 
+// element types with vector kernels; floating-point inputs must not contain NaNs
+template <typename T>
+concept SimdKey = std::same_as<T, std::int32_t> || std::same_as<T, std::int64_t> ||
+                  std::same_as<T, float> || std::same_as<T, double>;
+
+template <typename T>
+std::pair<T, T> minmaxScalar(std::span<const T> A) {
+    T minValue = A[0];
+    T maxValue = A[0];
+    for (size_t i = 1; i < A.size(); i++) {
+        minValue = std::min(minValue, A[i]);
+        maxValue = std::max(maxValue, A[i]);
+    }
+    return {minValue, maxValue};
+}
+
+// the two smallest elements (equal if the minimum occurs twice)
+template <typename T>
+std::pair<T, T> smallestTwoScalar(std::span<const T> A) {
+    assert(A.size() >= 2);
+    T first = std::min(A[0], A[1]);
+    T second = std::max(A[0], A[1]);
+    for (size_t i = 2; i < A.size(); i++) {
+        if (A[i] < second) {
+            second = std::max(first, A[i]);
+            first = std::min(first, A[i]);
+        }
+    }
+    return {first, second};
+}
+
+// index of the first smallest (Less = std::less) or first largest (Less = std::greater) element
+template <typename T, typename Less>
+size_t argBestScalar(std::span<const T> A, Less less) {
+    size_t best = 0;
+    for (size_t i = 1; i < A.size(); i++) {
+        if (less(A[i], A[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+#ifdef HAS_AVX2_KERNELS
+
+// one 256-bit register of T; Index is the lane-sized integer used to track positions
+template <typename T>
+struct Avx2;
+
+template <>
+struct Avx2<std::int32_t> {
+    using V = __m256i;
+    using Index = std::int32_t;
+    static constexpr size_t lanes = 8;
+    AVX2 static V load(const std::int32_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    AVX2 static void store(std::int32_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    AVX2 static V min(V a, V b) { return _mm256_min_epi32(a, b); }
+    AVX2 static V max(V a, V b) { return _mm256_max_epi32(a, b); }
+    AVX2 static __m256i less(V a, V b) { return _mm256_cmpgt_epi32(b, a); }
+    AVX2 static V select(__m256i mask, V a, V b) { return _mm256_blendv_epi8(b, a, mask); }
+    AVX2 static __m256i firstIndices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    AVX2 static __m256i broadcastIndex(Index i) { return _mm256_set1_epi32(i); }
+    AVX2 static __m256i addIndex(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+};
+
+template <>
+struct Avx2<std::int64_t> {
+    using V = __m256i;
+    using Index = std::int64_t;
+    static constexpr size_t lanes = 4;
+    AVX2 static V load(const std::int64_t* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    AVX2 static void store(std::int64_t* p, V v) { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+    // AVX2 has no 64-bit integer min/max, so they are built from a compare and a blend
+    AVX2 static __m256i less(V a, V b) { return _mm256_cmpgt_epi64(b, a); }
+    AVX2 static V select(__m256i mask, V a, V b) { return _mm256_blendv_epi8(b, a, mask); }
+    AVX2 static V min(V a, V b) { return select(less(a, b), a, b); }
+    AVX2 static V max(V a, V b) { return select(less(a, b), b, a); }
+    AVX2 static __m256i firstIndices() { return _mm256_setr_epi64x(0, 1, 2, 3); }
+    AVX2 static __m256i broadcastIndex(Index i) { return _mm256_set1_epi64x(i); }
+    AVX2 static __m256i addIndex(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+};
+
+template <>
+struct Avx2<float> {
+    using V = __m256;
+    using Index = std::int32_t;
+    static constexpr size_t lanes = 8;
+    AVX2 static V load(const float* p) { return _mm256_loadu_ps(p); }
+    AVX2 static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    AVX2 static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    AVX2 static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    AVX2 static __m256i less(V a, V b) { return _mm256_castps_si256(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+    AVX2 static V select(__m256i mask, V a, V b) { return _mm256_blendv_ps(b, a, _mm256_castsi256_ps(mask)); }
+    AVX2 static __m256i firstIndices() { return _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7); }
+    AVX2 static __m256i broadcastIndex(Index i) { return _mm256_set1_epi32(i); }
+    AVX2 static __m256i addIndex(__m256i a, __m256i b) { return _mm256_add_epi32(a, b); }
+};
+
+template <>
+struct Avx2<double> {
+    using V = __m256d;
+    using Index = std::int64_t;
+    static constexpr size_t lanes = 4;
+    AVX2 static V load(const double* p) { return _mm256_loadu_pd(p); }
+    AVX2 static void store(double* p, V v) { _mm256_storeu_pd(p, v); }
+    AVX2 static V min(V a, V b) { return _mm256_min_pd(a, b); }
+    AVX2 static V max(V a, V b) { return _mm256_max_pd(a, b); }
+    AVX2 static __m256i less(V a, V b) { return _mm256_castpd_si256(_mm256_cmp_pd(a, b, _CMP_LT_OQ)); }
+    AVX2 static V select(__m256i mask, V a, V b) { return _mm256_blendv_pd(b, a, _mm256_castsi256_pd(mask)); }
+    AVX2 static __m256i firstIndices() { return _mm256_setr_epi64x(0, 1, 2, 3); }
+    AVX2 static __m256i broadcastIndex(Index i) { return _mm256_set1_epi64x(i); }
+    AVX2 static __m256i addIndex(__m256i a, __m256i b) { return _mm256_add_epi64(a, b); }
+};
+
+struct MinOp {
+    template <typename S, typename V>
+    AVX2 static V apply(V a, V b) { return S::min(a, b); }
+    template <typename T>
+    static T apply(T a, T b) { return std::min(a, b); }
+};
+
+struct MaxOp {
+    template <typename S, typename V>
+    AVX2 static V apply(V a, V b) { return S::max(a, b); }
+    template <typename T>
+    static T apply(T a, T b) { return std::max(a, b); }
+};
+
+// four independent accumulators hide the latency of the min/max instruction
+template <typename T, typename Op>
+AVX2 T reduceAvx2(std::span<const T> A) {
+    using S = Avx2<T>;
+    constexpr size_t L = S::lanes;
+    const T* p = A.data();
+    size_t n = A.size();
+    T result = A[0];
+    size_t i = 0;
+    if (n >= 4 * L) {
+        auto m0 = S::load(p);
+        auto m1 = S::load(p + L);
+        auto m2 = S::load(p + 2 * L);
+        auto m3 = S::load(p + 3 * L);
+        for (i = 4 * L; i + 4 * L <= n; i += 4 * L) {
+            m0 = Op::template apply<S>(m0, S::load(p + i));
+            m1 = Op::template apply<S>(m1, S::load(p + i + L));
+            m2 = Op::template apply<S>(m2, S::load(p + i + 2 * L));
+            m3 = Op::template apply<S>(m3, S::load(p + i + 3 * L));
+        }
+        m0 = Op::template apply<S>(Op::template apply<S>(m0, m1), Op::template apply<S>(m2, m3));
+        T lanes[L];
+        S::store(lanes, m0);
+        for (auto x : lanes) {
+            result = Op::apply(result, x);
+        }
+    }
+    for (; i < n; i++) {
+        result = Op::apply(result, p[i]);
+    }
+    return result;
+}
+
+template <typename T>
+AVX2 std::pair<T, T> minmaxAvx2(std::span<const T> A) {
+    using S = Avx2<T>;
+    constexpr size_t L = S::lanes;
+    const T* p = A.data();
+    size_t n = A.size();
+    T minValue = A[0];
+    T maxValue = A[0];
+    size_t i = 0;
+    if (n >= 2 * L) {
+        auto v0 = S::load(p);
+        auto v1 = S::load(p + L);
+        auto lo0 = v0, hi0 = v0, lo1 = v1, hi1 = v1;
+        for (i = 2 * L; i + 2 * L <= n; i += 2 * L) {
+            v0 = S::load(p + i);
+            v1 = S::load(p + i + L);
+            lo0 = S::min(lo0, v0);
+            hi0 = S::max(hi0, v0);
+            lo1 = S::min(lo1, v1);
+            hi1 = S::max(hi1, v1);
+        }
+        T lo[L], hi[L];
+        S::store(lo, S::min(lo0, lo1));
+        S::store(hi, S::max(hi0, hi1));
+        for (size_t j = 0; j < L; j++) {
+            minValue = std::min(minValue, lo[j]);
+            maxValue = std::max(maxValue, hi[j]);
+        }
+    }
+    for (; i < n; i++) {
+        minValue = std::min(minValue, p[i]);
+        maxValue = std::max(maxValue, p[i]);
+    }
+    return {minValue, maxValue};
+}
+
+// every lane keeps the two smallest values it has seen; the lanes are merged at the end
+template <typename T>
+AVX2 std::pair<T, T> smallestTwoAvx2(std::span<const T> A) {
+    using S = Avx2<T>;
+    constexpr size_t L = S::lanes;
+    const T* p = A.data();
+    size_t n = A.size();
+    if (n < 4 * L) {
+        return smallestTwoScalar(A);
+    }
+    auto a0 = S::load(p);
+    auto b0 = S::load(p + L);
+    auto a1 = S::load(p + 2 * L);
+    auto b1 = S::load(p + 3 * L);
+    auto first0 = S::min(a0, b0), second0 = S::max(a0, b0);
+    auto first1 = S::min(a1, b1), second1 = S::max(a1, b1);
+    size_t i = 4 * L;
+    for (; i + 2 * L <= n; i += 2 * L) {
+        auto v0 = S::load(p + i);
+        auto v1 = S::load(p + i + L);
+        second0 = S::min(second0, S::max(first0, v0));
+        first0 = S::min(first0, v0);
+        second1 = S::min(second1, S::max(first1, v1));
+        first1 = S::min(first1, v1);
+    }
+    T candidates[4 * L];
+    S::store(candidates, first0);
+    S::store(candidates + L, second0);
+    S::store(candidates + 2 * L, first1);
+    S::store(candidates + 3 * L, second1);
+    auto [first, second] = smallestTwoScalar(std::span<const T>(candidates));
+    for (; i < n; i++) {
+        if (p[i] < second) {
+            second = std::max(first, p[i]);
+            first = std::min(first, p[i]);
+        }
+    }
+    return {first, second};
+}
+
+// Better::apply(S, a, b) is the mask of lanes where a should replace b; two accumulators, each
+// with its own index register, and ties keep the lowest index
+struct Smaller {
+    template <typename S, typename V>
+    AVX2 static __m256i apply(V a, V b) { return S::less(a, b); }
+    template <typename T>
+    static bool apply(T a, T b) { return a < b; }
+};
+
+struct Larger {
+    template <typename S, typename V>
+    AVX2 static __m256i apply(V a, V b) { return S::less(b, a); }
+    template <typename T>
+    static bool apply(T a, T b) { return b < a; }
+};
+
+template <typename T, typename Better>
+AVX2 size_t argBestAvx2(std::span<const T> A) {
+    using S = Avx2<T>;
+    using Index = typename S::Index;
+    constexpr size_t L = S::lanes;
+    const T* p = A.data();
+    size_t n = A.size();
+    // positions must fit in a lane
+    assert(n <= static_cast<size_t>(std::numeric_limits<Index>::max()));
+    size_t i = 0;
+    size_t best = 0;
+    if (n >= 2 * L) {
+        auto idx0 = S::firstIndices();
+        auto idx1 = S::addIndex(idx0, S::broadcastIndex(L));
+        auto step = S::broadcastIndex(2 * L);
+        auto m0 = S::load(p);
+        auto m1 = S::load(p + L);
+        auto at0 = idx0, at1 = idx1;
+        for (i = 2 * L; i + 2 * L <= n; i += 2 * L) {
+            idx0 = S::addIndex(idx0, step);
+            idx1 = S::addIndex(idx1, step);
+            auto v0 = S::load(p + i);
+            auto v1 = S::load(p + i + L);
+            auto c0 = Better::template apply<S>(v0, m0);
+            auto c1 = Better::template apply<S>(v1, m1);
+            m0 = S::select(c0, v0, m0);
+            m1 = S::select(c1, v1, m1);
+            at0 = _mm256_blendv_epi8(at0, idx0, c0);
+            at1 = _mm256_blendv_epi8(at1, idx1, c1);
+        }
+        T values[2 * L];
+        Index positions[2 * L];
+        S::store(values, m0);
+        S::store(values + L, m1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(positions), at0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(positions + L), at1);
+        size_t j = 0;
+        for (size_t k = 1; k < 2 * L; k++) {
+            if (Better::apply(values[k], values[j]) || (values[k] == values[j] && positions[k] < positions[j])) {
+                j = k;
+            }
+        }
+        best = static_cast<size_t>(positions[j]);
+    }
+    for (; i < n; i++) {
+        if (Better::apply(p[i], p[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+#endif
+
+bool hasAvx2() {
+#ifdef HAS_AVX2_KERNELS
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+#else
+    return false;
+#endif
+}
+
+// the functions below run the AVX2 kernels when the CPU has them and scalar loops otherwise
+
+template <SimdKey T>
+T minimumSimd(std::span<const T> A) {
+#ifdef HAS_AVX2_KERNELS
+    if (hasAvx2()) {
+        return reduceAvx2<T, MinOp>(A);
+    }
+#endif
+    return *std::min_element(A.begin(), A.end());
+}
+
+template <SimdKey T>
+T maximumSimd(std::span<const T> A) {
+#ifdef HAS_AVX2_KERNELS
+    if (hasAvx2()) {
+        return reduceAvx2<T, MaxOp>(A);
+    }
+#endif
+    return *std::max_element(A.begin(), A.end());
+}
+
+template <SimdKey T>
+std::pair<T, T> minmaxSimd(std::span<const T> A) {
+#ifdef HAS_AVX2_KERNELS
+    if (hasAvx2()) {
+        return minmaxAvx2(A);
+    }
+#endif
+    return minmaxScalar(A);
+}
+
+template <SimdKey T>
+std::pair<T, T> smallestTwoSimd(std::span<const T> A) {
+#ifdef HAS_AVX2_KERNELS
+    if (hasAvx2()) {
+        return smallestTwoAvx2(A);
+    }
+#endif
+    return smallestTwoScalar(A);
+}
+
+template <SimdKey T>
+size_t argminSimd(std::span<const T> A) {
+#ifdef HAS_AVX2_KERNELS
+    if (hasAvx2() && A.size() <= static_cast<size_t>(std::numeric_limits<typename Avx2<T>::Index>::max())) {
+        return argBestAvx2<T, Smaller>(A);
+    }
+#endif
+    return argBestScalar(A, std::less<>{});
+}
+
+template <SimdKey T>
+size_t argmaxSimd(std::span<const T> A) {
+#ifdef HAS_AVX2_KERNELS
+    if (hasAvx2() && A.size() <= static_cast<size_t>(std::numeric_limits<typename Avx2<T>::Index>::max())) {
+        return argBestAvx2<T, Larger>(A);
+    }
+#endif
+    return argBestScalar(A, std::greater<>{});
+}
+
+std::mt19937 gen(std::random_device{}());
+
+template <SimdKey T>
+std::vector<T> randomVector(size_t n) {
+    std::vector<T> A (n);
+    if constexpr (std::is_integral_v<T>) {
+        std::uniform_int_distribution<T> dist(std::numeric_limits<T>::min(), std::numeric_limits<T>::max());
+        for (auto& x : A) {
+            x = dist(gen);
+        }
+    } else {
+        std::uniform_real_distribution<T> dist(-1e6, 1e6);
+        for (auto& x : A) {
+            x = dist(gen);
+        }
+    }
+    return A;
+}
+
+template <SimdKey T>
+void checkKernels() {
+    std::uniform_int_distribution<> small(-20, 20);
+    for (size_t n = 2; n < 300; n++) {
+        std::vector<T> A (n);
+        for (auto& x : A) {
+            x = static_cast<T>(small(gen));
+        }
+        std::span<const T> s (A);
+        assert(minimumSimd(s) == minimum(A));
+        assert(maximumSimd(s) == maximum(A));
+        assert(minmaxSimd(s) == std::make_pair(minimum(A), maximum(A)));
+        auto sorted = A;
+        std::sort(sorted.begin(), sorted.end());
+        assert(smallestTwoSimd(s) == std::make_pair(sorted[0], sorted[1]));
+        assert(smallestTwoScalar(s) == std::make_pair(sorted[0], sorted[1]));
+        assert(argminSimd(s) == static_cast<size_t>(std::min_element(A.begin(), A.end()) - A.begin()));
+        assert(argmaxSimd(s) == static_cast<size_t>(std::max_element(A.begin(), A.end()) - A.begin()));
+    }
+}
+
+constexpr size_t TRIALS = 20;
+
+template <typename F>
+void report(const std::string& name, size_t bytes, F f) {
+    crn::nanoseconds DT (0);
+    for (size_t t = 0; t < TRIALS; t++) {
+        auto t1 = crn::steady_clock::now();
+        f();
+        auto t2 = crn::steady_clock::now();
+        DT += crn::duration_cast<crn::nanoseconds>(t2 - t1);
+    }
+    double seconds = static_cast<double>(DT.count()) / 1e9 / TRIALS;
+    std::cout << "  " << name << " : " << static_cast<double>(bytes) / seconds / 1e9 << " GB/s\n";
+}
+
+template <SimdKey T>
+void benchmark(const char* type, size_t n) {
+    auto A = randomVector<T>(n);
+    std::span<const T> s (A);
+    size_t bytes = n * sizeof(T);
+    std::cout << n << " " << type << " elements\n";
+    // a volatile sink keeps the calls from being optimized away
+    volatile T sink {};
+    volatile size_t index_sink = 0;
+    report("minimum (scalar)", bytes, [&] { sink = minimum(A); });
+    report("minimum (simd)", bytes, [&] { sink = minimumSimd(s); });
+    report("maximum (scalar)", bytes, [&] { sink = maximum(A); });
+    report("maximum (simd)", bytes, [&] { sink = maximumSimd(s); });
+    report("minmax (scalar)", bytes, [&] { sink = minmaxScalar(s).second; });
+    report("minmax (simd)", bytes, [&] { sink = minmaxSimd(s).second; });
+    report("two smallest (scalar)", bytes, [&] { sink = smallestTwoScalar(s).second; });
+    report("two smallest (simd)", bytes, [&] { sink = smallestTwoSimd(s).second; });
+    report("argmin (scalar)", bytes, [&] { index_sink = argBestScalar(s, std::less<>{}); });
+    report("argmin (simd)", bytes, [&] { index_sink = argminSimd(s); });
+    report("argmax (scalar)", bytes, [&] { index_sink = argBestScalar(s, std::greater<>{}); });
+    report("argmax (simd)", bytes, [&] { index_sink = argmaxSimd(s); });
+    assert(minimumSimd(s) == minimum(A) && argmaxSimd(s) == argBestScalar(s, std::greater<>{}));
+}
+
 int main() {
+    std::vector<int> v {3, 1, 4, 1, 5, 9, 2, 6};
+    assert(minimum(v) == 1 && maximum(v) == 9);
+
+    checkKernels<std::int32_t>();
+    checkKernels<std::int64_t>();
+    checkKernels<float>();
+    checkKernels<double>();
 
+    std::cout << "AVX2 kernels " << (hasAvx2() ? "enabled" : "not available, using scalar fallback") << '\n';
+    constexpr size_t N = 1 << 20;
+    benchmark<std::int32_t>("int32", N);
+    benchmark<std::int64_t>("int64", N);
+    benchmark<float>("float", N);
+    benchmark<double>("double", N);
 }
\ No newline at end of file
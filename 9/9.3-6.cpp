@@ -1,10 +1,17 @@
 #include <algorithm>
+#include <bit>
 #include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
 #include <iostream>
 #include <random>
+#include <span>
 #include <utility>
 #include <vector>
 
+namespace crn = std::chrono;
+
 std::mt19937 gen(std::random_device{}());
 
 template <typename T>
@@ -49,38 +56,268 @@ std::pair<size_t, T> randomizedSelect(std::vector<T>& A, size_t p, size_t r, siz
     }
 }
 
+// The selection routines below work on the closed range A[left..right] with signed indices,
+// use 0-based ranks, and leave A[k] holding the element of rank k with everything before it
+// not greater and everything after it not less.
+
+template <typename T>
+void insertionSort(std::vector<T>& A, std::ptrdiff_t left, std::ptrdiff_t right) {
+    for (std::ptrdiff_t j = left + 1; j <= right; j++) {
+        T key = std::move(A[j]);
+        std::ptrdiff_t i = j;
+        while (i > left && key < A[i - 1]) {
+            A[i] = std::move(A[i - 1]);
+            i--;
+        }
+        A[i] = std::move(key);
+    }
+}
+
+// splits A[left..right] into < pivot, == pivot, > pivot and returns the bounds of the middle part
+template <typename T>
+std::pair<std::ptrdiff_t, std::ptrdiff_t> threeWayPartition(std::vector<T>& A, std::ptrdiff_t left,
+                                                            std::ptrdiff_t right, const T pivot) {
+    std::ptrdiff_t lt = left;
+    std::ptrdiff_t j = left;
+    std::ptrdiff_t gt = right;
+    while (j <= gt) {
+        if (A[j] < pivot) {
+            std::swap(A[lt++], A[j++]);
+        } else if (pivot < A[j]) {
+            std::swap(A[j], A[gt--]);
+        } else {
+            j++;
+        }
+    }
+    return {lt, gt};
+}
+
+// worst-case linear selection; the group medians are gathered at the front of the range
+// instead of being copied into a separate vector
+template <typename T>
+void medianOfMediansSelect(std::vector<T>& A, std::ptrdiff_t left, std::ptrdiff_t right, std::ptrdiff_t k) {
+    while (true) {
+        if (right - left < 5) {
+            insertionSort(A, left, right);
+            return;
+        }
+        std::ptrdiff_t groups = 0;
+        for (std::ptrdiff_t g = left; g <= right; g += 5) {
+            std::ptrdiff_t last = std::min(g + 4, right);
+            insertionSort(A, g, last);
+            std::swap(A[left + groups++], A[g + (last - g) / 2]);
+        }
+        std::ptrdiff_t mid = left + (groups - 1) / 2;
+        medianOfMediansSelect(A, left, left + groups - 1, mid);
+        auto [lt, gt] = threeWayPartition(A, left, right, A[mid]);
+        if (k < lt) {
+            right = lt - 1;
+        } else if (k > gt) {
+            left = gt + 1;
+        } else {
+            return;
+        }
+    }
+}
+
+// Floyd and Rivest's SELECT: recursively select from a small window around k so that A[k]
+// becomes a pivot that lands very close to rank k, then partition once around it. When the
+// loop needs more rounds than a well-behaved run would, median of medians finishes the job.
+template <typename T>
+void floydRivestSelect(std::vector<T>& A, std::ptrdiff_t left, std::ptrdiff_t right, std::ptrdiff_t k) {
+    constexpr std::ptrdiff_t SAMPLE_THRESHOLD = 600;
+    std::size_t rounds = 0;
+    const std::size_t maxRounds = 2 * std::bit_width(static_cast<std::size_t>(right - left + 1)) + 4;
+    while (right > left) {
+        if (++rounds > maxRounds) {
+            medianOfMediansSelect(A, left, right, k);
+            return;
+        }
+        if (right - left > SAMPLE_THRESHOLD) {
+            double n = static_cast<double>(right - left + 1);
+            double i = static_cast<double>(k - left + 1);
+            double z = std::log(n);
+            double s = 0.5 * std::exp(2 * z / 3);
+            double sd = 0.5 * std::sqrt(z * s * (n - s) / n) * (i < n / 2 ? -1 : 1);
+            auto newLeft = std::max(left, static_cast<std::ptrdiff_t>(static_cast<double>(k) - i * s / n + sd));
+            auto newRight = std::min(right, static_cast<std::ptrdiff_t>(static_cast<double>(k) + (n - i) * s / n + sd));
+            // the window only predicts where rank k lies if it is a random sample of the range,
+            // which it is not when A was partitioned before (e.g. by selecting another rank)
+            std::uniform_int_distribution<std::ptrdiff_t> pick(left, right);
+            for (auto w = newLeft; w <= newRight; w++) {
+                std::swap(A[w], A[pick(gen)]);
+            }
+            floydRivestSelect(A, newLeft, newRight, k);
+        }
+        const T t = A[k];
+        std::ptrdiff_t i = left;
+        std::ptrdiff_t j = right;
+        std::swap(A[left], A[k]);
+        if (t < A[right]) {
+            std::swap(A[right], A[left]);
+        }
+        while (i < j) {
+            std::swap(A[i], A[j]);
+            i++;
+            j--;
+            while (A[i] < t) {
+                i++;
+            }
+            while (t < A[j]) {
+                j--;
+            }
+        }
+        if (!(A[left] < t) && !(t < A[left])) {
+            std::swap(A[left], A[j]);
+        } else {
+            j++;
+            std::swap(A[j], A[right]);
+        }
+        if (j <= k) {
+            left = j + 1;
+        }
+        if (k <= j) {
+            right = j - 1;
+        }
+    }
+}
+
+template <typename T>
+T floydRivestSelect(std::vector<T>& A, std::size_t k) {
+    assert(k < A.size());
+    floydRivestSelect(A, 0, static_cast<std::ptrdiff_t>(A.size()) - 1, static_cast<std::ptrdiff_t>(k));
+    return A[k];
+}
+
+// selects the middle requested rank, after which the ranks below and above it only need to be
+// searched for in the parts of A on either side of it
+template <typename T>
+void multiSelect(std::vector<T>& A, std::ptrdiff_t left, std::ptrdiff_t right, std::span<const std::size_t> ranks) {
+    while (!ranks.empty()) {
+        std::size_t mid = ranks.size() / 2;
+        auto k = static_cast<std::ptrdiff_t>(ranks[mid]);
+        floydRivestSelect(A, left, right, k);
+        multiSelect(A, left, k - 1, ranks.first(mid));
+        left = k + 1;
+        ranks = ranks.subspan(mid + 1);
+    }
+}
+
+// returns the elements of the given 0-based ranks, in the order the ranks were given
 template <typename T>
-void kthQuantilesHelper(std::vector<T>& A, size_t p, size_t r,
-        std::vector<size_t>& pos, size_t f, size_t e, std::vector<T>& quantiles) {
-    if (f >= e) {
-        return;
-    }
-    size_t mid = (f + e) / 2;
-    auto [q, val] = randomizedSelect(A, p, r, pos[mid]);
-    quantiles[mid] = val;
-    size_t k = q - p + 1;
-    for (size_t i = mid + 1; i < e; i++) {
-        pos[i] -= k;
-    }
-    kthQuantilesHelper(A, q + 1, r, pos, mid + 1, e, quantiles);
+std::vector<T> multiSelect(std::vector<T>& A, std::span<const std::size_t> ranks) {
+    std::vector<std::size_t> sorted (ranks.begin(), ranks.end());
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    assert(sorted.empty() || sorted.back() < A.size());
+    multiSelect(A, 0, static_cast<std::ptrdiff_t>(A.size()) - 1, std::span<const std::size_t>(sorted));
+    std::vector<T> values;
+    values.reserve(ranks.size());
+    for (auto k : ranks) {
+        values.push_back(A[k]);
+    }
+    return values;
 }
 
+// nearest-rank quantiles: q = 0.99 gives the element that 99% of A does not exceed
+template <typename T>
+std::vector<T> quantiles(std::vector<T>& A, std::span<const double> qs) {
+    std::vector<std::size_t> ranks;
+    for (auto q : qs) {
+        auto rank = static_cast<std::size_t>(std::ceil(q * static_cast<double>(A.size())));
+        ranks.push_back(std::clamp<std::size_t>(rank, 1, A.size()) - 1);
+    }
+    return multiSelect(A, ranks);
+}
+
+// the k - 1 order statistics that split A into k equal-sized parts: the elements that would sit
+// at positions i * n / k, 0 < i < k, of the sorted array
 template <typename T>
 std::vector<T> kthQuantiles(std::vector<T>& A, size_t k) {
-    std::vector<size_t> pos (k);
-    for (size_t i = 0; i < pos.size(); i++) {
-        pos[i] = i * A.size() / k;
+    std::vector<size_t> pos;
+    for (size_t i = 1; i < k; i++) {
+        pos.push_back(i * A.size() / k);
     }
-    std::vector<T> quantiles (k);
-    kthQuantilesHelper(A, 0, A.size() - 1, pos, 0, pos.size(), quantiles);
-    return quantiles;
+    return multiSelect(A, pos);
 }
 
 int main() {
     std::vector<int> v {3, 2, 6, 1, 5, 4, 8, 7};
     auto v_3 = kthQuantiles(v, 3);
+    assert((v_3 == std::vector<int> {3, 6}));
     for (auto n : v_3) {
         std::cout << n << ' ';
     }
+    std::cout << '\n';
+
+    for (size_t n = 1; n < 3'000; n += 37) {
+        std::uniform_int_distribution<> dist(0, static_cast<int>(n / 4));
+        std::vector<int> A (n);
+        for (auto& x : A) {
+            x = dist(gen);
+        }
+        auto sorted = A;
+        std::sort(sorted.begin(), sorted.end());
+        for (size_t k : {size_t {0}, n / 3, n / 2, n - 1}) {
+            auto B = A;
+            assert(floydRivestSelect(B, k) == sorted[k]);
+            assert(std::all_of(B.begin(), B.begin() + k, [&](int x) { return x <= B[k]; }));
+            assert(std::all_of(B.begin() + k, B.end(), [&](int x) { return x >= B[k]; }));
+            B = A;
+            medianOfMediansSelect(B, 0, static_cast<std::ptrdiff_t>(n) - 1, static_cast<std::ptrdiff_t>(k));
+            assert(B[k] == sorted[k]);
+        }
+        auto B = A;
+        for (size_t k = 1; k <= 10; k++) {
+            auto qs = kthQuantiles(B, k);
+            for (size_t i = 1; i < k; i++) {
+                assert(qs[i - 1] == sorted[i * n / k]);
+            }
+        }
+    }
 
+    // request latencies in microseconds: log-normal with a long tail
+    constexpr size_t N = 100'000'000;
+    std::lognormal_distribution<> latency(6.0, 1.0);
+    std::vector<int> window (N);
+    for (auto& x : window) {
+        x = static_cast<int>(latency(gen));
+    }
+    const std::vector<double> qs {0.5, 0.9, 0.99, 0.999};
+    std::vector<size_t> ranks;
+    for (auto q : qs) {
+        ranks.push_back(static_cast<size_t>(std::ceil(q * N)) - 1);
+    }
+
+    auto A = window;
+    auto t1 = crn::steady_clock::now();
+    std::vector<int> expected;
+    for (auto k : ranks) {
+        std::nth_element(A.begin(), A.begin() + k, A.end());
+        expected.push_back(A[k]);
+    }
+    auto t2 = crn::steady_clock::now();
+
+    A = window;
+    auto t3 = crn::steady_clock::now();
+    std::vector<int> single;
+    for (auto k : ranks) {
+        single.push_back(floydRivestSelect(A, k));
+    }
+    auto t4 = crn::steady_clock::now();
+
+    A = window;
+    auto t5 = crn::steady_clock::now();
+    auto batched = quantiles(A, qs);
+    auto t6 = crn::steady_clock::now();
+
+    assert(single == expected && batched == expected);
+    std::cout << "p50/p90/p99/p999 of " << N << " latencies : ";
+    for (auto x : batched) {
+        std::cout << x << "us ";
+    }
+    std::cout << '\n';
+    std::cout << "  std::nth_element per quantile : " << crn::duration_cast<crn::milliseconds>(t2 - t1).count() << "ms\n";
+    std::cout << "  Floyd-Rivest per quantile : " << crn::duration_cast<crn::milliseconds>(t4 - t3).count() << "ms\n";
+    std::cout << "  Floyd-Rivest multi-select : " << crn::duration_cast<crn::milliseconds>(t6 - t5).count() << "ms\n";
 }
\ No newline at end of file
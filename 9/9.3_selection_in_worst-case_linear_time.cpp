@@ -42,8 +42,9 @@ T Select(std::vector<T>& A, std::size_t p, std::size_t r, std::size_t i) {
         std::nth_element(A.begin() + p, A.begin() + p + i, A.begin() + r + 1);
         return A[p + i];
     }
-    std::size_t groups = std::ceil(size / 5);
-    std::size_t full_groups = std::floor(size / 5);
+    // size / 5 is already integer division, so rounding it up has to be done by hand
+    std::size_t groups = (size + 4) / 5;
+    std::size_t full_groups = size / 5;
     std::vector<T> B (groups);
     for (std::size_t g = 0; g < full_groups; g++) {
         makeMedian(A, p + 5 * g, p + 5 * g + 5);